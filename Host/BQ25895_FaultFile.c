@@ -0,0 +1,46 @@
+/**
+ *  @brief     File backend for the BQ25895 fault history on the Linux host.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#include "main.h"
+#include "BQ25895_FaultFile.h"
+
+/**
+ * @brief Append events as "tick,device,fault" lines, one batch per fflush().
+ */
+static HAL_StatusTypeDef BQ25895_FaultFile_Write(void *context, const BQ25895_FAULT_EVENT *events, uint16_t count) {
+    BQ25895_FAULT_FILE *store = (BQ25895_FAULT_FILE *) context;
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        if (fprintf(store->file, "%lu,%u,0x%02X\n", (unsigned long) events[i].tick, events[i].device,
+                events[i].fault) < 0)
+            return HAL_ERROR;
+    }
+    return (fflush(store->file) == 0) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Open (or create) a fault history file for appending.
+ * @param[out] *store Backend to fill in.
+ * @param[in] *path File, earlier history is kept.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ */
+HAL_StatusTypeDef BQ25895_FaultFileOpen(BQ25895_FAULT_FILE *store, const char *path) {
+    store->file = fopen(path, "a");
+    store->backend.write = BQ25895_FaultFile_Write;
+    store->backend.context = store;
+    return (store->file != NULL) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Close the file. Flush the logs using it with BQ25895_FaultLogService(log, 1) first.
+ */
+void BQ25895_FaultFileClose(BQ25895_FAULT_FILE *store) {
+    if (store->file != NULL)
+        fclose(store->file);
+    store->file = NULL;
+}
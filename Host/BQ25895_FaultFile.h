@@ -0,0 +1,34 @@
+/**
+ *  @brief     File backend for the BQ25895 fault history on the Linux host.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_FAULTFILE_H
+#define BQ25895_FAULTFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+#include "BQ25895_FaultLog.h"
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_FAULT_FILE {
+    FILE *file;
+    BQ25895_FAULT_BACKEND backend;  /**< Pass &backend to BQ25895_FaultLogInit() */
+} BQ25895_FAULT_FILE;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_FaultFileOpen(BQ25895_FAULT_FILE *store, const char *path);
+
+void BQ25895_FaultFileClose(BQ25895_FAULT_FILE *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_FAULTFILE_H */
@@ -0,0 +1,306 @@
+/**
+ *  @brief     C++20 coroutine wrapper driving many BQ25895 chargers from one host thread.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_HOST_HPP
+#define BQ25895_HOST_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BQ25895.h"
+#include "BQ25895_Async.h"
+
+namespace bq25895 {
+
+/**
+ * @brief Coroutine returning a HAL status. Started by Loop::Spawn() or by being awaited from another task.
+ */
+class Task {
+public:
+    struct promise_type {
+        HAL_StatusTypeDef result = HAL_OK;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        auto final_suspend() noexcept {
+            struct Final {
+                bool await_ready() noexcept {
+                    return false;
+                }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    auto next = h.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {
+                }
+            };
+            return Final {};
+        }
+        void return_value(HAL_StatusTypeDef status) {
+            result = status;
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {
+    }
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {
+    }
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool Done() const {
+        return !handle_ || handle_.done();
+    }
+    HAL_StatusTypeDef Result() const {
+        return handle_.promise().result;
+    }
+    std::coroutine_handle<> Handle() const {
+        return handle_;
+    }
+
+    bool await_ready() const {
+        return Done();
+    }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    HAL_StatusTypeDef await_resume() const {
+        return Result();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Single threaded event loop: a FIFO of runnable coroutines plus timers on HAL_GetTick().
+ */
+class Loop {
+public:
+    void Spawn(Task task) {
+        Schedule(task.Handle());
+        tasks_.push_back(std::move(task));
+    }
+
+    void Schedule(std::coroutine_handle<> handle) {
+        ready_.push_back(handle);
+    }
+
+    void At(uint32_t due_tick, std::coroutine_handle<> handle) {
+        timers_.push(Timer { due_tick, sequence_++, handle });
+    }
+
+    /** Let every other runnable coroutine run once */
+    auto Yield() {
+        struct Awaiter {
+            Loop &loop;
+            bool await_ready() const {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> h) {
+                loop.Schedule(h);
+            }
+            void await_resume() const {
+            }
+        };
+        return Awaiter { *this };
+    }
+
+    auto Sleep(uint32_t ms) {
+        struct Awaiter {
+            Loop &loop;
+            uint32_t ms;
+            bool await_ready() const {
+                return ms == 0;
+            }
+            void await_suspend(std::coroutine_handle<> h) {
+                loop.At(HAL_GetTick() + ms, h);
+            }
+            void await_resume() const {
+            }
+        };
+        return Awaiter { *this, ms };
+    }
+
+    /** Run until every spawned task finished, sleeping while only timers are pending */
+    void Run() {
+        while (!ready_.empty() || !timers_.empty()) {
+            uint32_t now = HAL_GetTick();
+            while (!timers_.empty() && static_cast<int32_t>(now - timers_.top().due) >= 0) {
+                ready_.push_back(timers_.top().handle);
+                timers_.pop();
+            }
+            if (ready_.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timers_.top().due - now));
+                continue;
+            }
+            auto handle = ready_.front();
+            ready_.pop_front();
+            handle.resume();
+        }
+    }
+
+    /** Spawned tasks in spawn order, finished ones hold their result */
+    const std::vector<Task> &Tasks() const {
+        return tasks_;
+    }
+
+    /** Driver calls and operation steps completed, for operations per second measurements */
+    uint64_t Operations() const {
+        return operations_;
+    }
+    void CountOperation() {
+        operations_++;
+    }
+
+private:
+    struct Timer {
+        uint32_t due;
+        uint64_t sequence;
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer &other) const {
+            int32_t diff = static_cast<int32_t>(due - other.due);
+            return diff != 0 ? diff > 0 : sequence > other.sequence;
+        }
+    };
+
+    std::deque<std::coroutine_handle<>> ready_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    std::vector<Task> tasks_;
+    uint64_t sequence_ = 0;
+    uint64_t operations_ = 0;
+};
+
+/**
+ * @brief One BQ25895 on a bus. Every driver call is an awaitable that lets the other chargers run first.
+ */
+class Charger {
+public:
+    Charger(Loop &loop, BQ25895_BUS *bus, uint16_t addr = BQ25895_I2C_ADDR, BQ25895_BUS_MUX *mux = nullptr,
+            uint8_t channel = 0) : loop_(loop), device_ {} {
+        device_.bus = bus;
+        device_.addr = addr;
+        device_.mux = mux;
+        device_.channel = channel;
+    }
+
+    const BQ25895_BUS_DEVICE *Device() const {
+        return &device_;
+    }
+
+    /**
+     * @brief Await any function of BQ25895.h on this charger, e.g. co_await charger.Call(BQ25895_SetChargeVoltage, &mv).
+     * @note Pointer arguments must stay valid until the call is resumed. The charger is selected only for
+     * the duration of the call; the selection is per thread (BQ25895_SelectDevice()), so loops on other
+     * threads are not affected.
+     */
+    template <typename... Params, typename... Args>
+    auto Call(HAL_StatusTypeDef (*fn)(Params...), Args... args) {
+        auto call = [fn, args...]() {
+            return fn(args...);
+        };
+        struct Awaiter {
+            Charger &charger;
+            decltype(call) invoke;
+            bool await_ready() const {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> h) {
+                charger.loop_.Schedule(h);
+            }
+            HAL_StatusTypeDef await_resume() {
+                const BQ25895_BUS_DEVICE *selected = BQ25895_GetSelectedDevice();
+                BQ25895_SelectDevice(&charger.device_);
+                HAL_StatusTypeDef status = invoke();
+                BQ25895_SelectDevice(selected);
+                charger.loop_.CountOperation();
+                return status;
+            }
+        };
+        return Awaiter { *this, call };
+    }
+
+    auto Read(uint8_t reg, uint8_t *data, uint16_t len = 1) {
+        return Call(BQ25895_DeviceRead, Device(), reg, data, len);
+    }
+
+    auto Write(uint8_t reg, uint8_t *data) {
+        return Call(BQ25895_DeviceWrite, Device(), reg, data, (uint16_t) 1);
+    }
+
+    auto Sleep(uint32_t ms) {
+        return loop_.Sleep(ms);
+    }
+
+    /**
+     * @brief Await a BQ25895_Async.h operation, e.g. co_await charger.Run(BQ25895_AsyncICO, op).
+     * @note The operation is polled once per loop millisecond, op must outlive the await.
+     */
+    Task Run(HAL_StatusTypeDef (*operation)(BQ25895_ASYNC *), BQ25895_ASYNC &op, uint32_t timeout_ms = 0) {
+        HAL_StatusTypeDef status;
+        BQ25895_AsyncInit(&op, &device_, timeout_ms);
+        while ((status = operation(&op)) == HAL_BUSY) {
+            loop_.CountOperation();
+            co_await loop_.Sleep(1);
+        }
+        co_return status;
+    }
+
+    /**
+     * @brief Await a BQ25895_Async.h operation taking arguments, e.g.
+     * co_await charger.Run(BQ25895_AsyncShipMode, op, 0, BQ25895_ENABLED).
+     * @note The arguments are copied into the coroutine and passed on every poll.
+     */
+    template <typename... Params, typename... Args>
+        requires (sizeof...(Params) > 0 && sizeof...(Params) == sizeof...(Args))
+    Task Run(HAL_StatusTypeDef (*operation)(BQ25895_ASYNC *, Params...), BQ25895_ASYNC &op, uint32_t timeout_ms,
+            Args... args) {
+        HAL_StatusTypeDef status;
+        BQ25895_AsyncInit(&op, &device_, timeout_ms);
+        while ((status = operation(&op, args...)) == HAL_BUSY) {
+            loop_.CountOperation();
+            co_await loop_.Sleep(1);
+        }
+        co_return status;
+    }
+
+private:
+    Loop &loop_;
+    BQ25895_BUS_DEVICE device_;
+};
+
+} // namespace bq25895
+
+#endif /* BQ25895_HOST_HPP */
@@ -0,0 +1,94 @@
+/**
+ *  @brief     Operations per second of the coroutine host driver on simulated chargers.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ *
+ *  gcc -std=c11 -O2 -c -IHost -IInclude Source/BQ25895*.c Host/BQ25895_LinuxI2C.c
+ *  g++ -std=c++20 -O2 -IHost -IInclude Host/BQ25895_HostBench.cpp BQ25895*.o -o bq25895_bench
+ *  ./bq25895_bench [chargers] [iterations]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "BQ25895_Host.hpp"
+
+namespace {
+
+/* Register files of up to 128 chargers, one per 7 bit address */
+struct Simulator {
+    uint8_t regs[128][BQ25895_REG_COUNT];
+};
+
+HAL_StatusTypeDef Simulate(void *context, uint16_t addr, uint8_t reg, uint8_t *data, uint16_t len, uint8_t write) {
+    uint8_t *chip = static_cast<Simulator *>(context)->regs[(addr >> 1) & 0x7F];
+    if (reg + len > BQ25895_REG_COUNT)
+        return HAL_ERROR;
+    if (!write) {
+        std::memcpy(data, &chip[reg], len);
+        return HAL_OK;
+    }
+    std::memcpy(&chip[reg], data, len);
+    /* Self clearing bits finish immediately */
+    chip[BQ25895_REG_02] &= ~BQ25895_CONV_START_MASK;
+    chip[BQ25895_REG_14] &= ~BQ25895_RESET_MASK;
+    if (chip[BQ25895_REG_09] & BQ25895_FORCE_ICO_MASK) {
+        chip[BQ25895_REG_09] &= ~BQ25895_FORCE_ICO_MASK;
+        chip[BQ25895_REG_14] |= BQ25895_ICO_OPTIMIZED_MASK;
+    }
+    return HAL_OK;
+}
+
+bq25895::Task Exercise(bq25895::Charger &charger, int iterations) {
+    uint16_t vreg_mv = 4208;
+    uint16_t current_ma = 2048;
+    uint16_t vbat_mv;
+    uint8_t regs[BQ25895_REG_14 - BQ25895_REG_0B + 1];
+    BQ25895_ASYNC op;
+    if (co_await charger.Run(BQ25895_AsyncICO, op) != HAL_OK)
+        co_return HAL_ERROR;
+    for (int i = 0; i < iterations; i++) {
+        co_await charger.Call(BQ25895_SetChargeVoltage, &vreg_mv);
+        co_await charger.Call(BQ25895_SetFastChargeCurrent, &current_ma);
+        co_await charger.Call(BQ25895_GetBatteryVoltage, &vbat_mv);
+        co_await charger.Read(BQ25895_REG_0B, regs, sizeof(regs));
+    }
+    co_return co_await charger.Run(BQ25895_AsyncShipMode, op, 0, BQ25895_ENABLED);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int chargers = (argc > 1) ? std::atoi(argv[1]) : 100;
+    int iterations = (argc > 2) ? std::atoi(argv[2]) : 1000;
+    auto simulator = std::make_unique<Simulator>();
+    I2C_HandleTypeDef i2c = { -1, Simulate, simulator.get() };
+    BQ25895_BUS bus;
+    bq25895::Loop loop;
+    std::vector<std::unique_ptr<bq25895::Charger>> bays;
+
+    if (chargers < 1 || chargers > 128)
+        chargers = 128;
+    BQ25895_Init(&i2c);
+    BQ25895_BusInit(&bus, &i2c, 400000);
+    for (int i = 0; i < chargers; i++) {
+        bays.push_back(std::make_unique<bq25895::Charger>(loop, &bus, static_cast<uint16_t>(i << 1)));
+        loop.Spawn(Exercise(*bays.back(), iterations));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    loop.Run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (size_t i = 0; i < loop.Tasks().size(); i++) {
+        if (!loop.Tasks()[i].Done() || loop.Tasks()[i].Result() != HAL_OK)
+            std::printf("charger %zu failed\n", i);
+    }
+    std::printf("%d chargers, %llu operations in %.3f s: %.0f operations/s\n", chargers,
+            static_cast<unsigned long long>(loop.Operations()), elapsed.count(), loop.Operations() / elapsed.count());
+    return 0;
+}
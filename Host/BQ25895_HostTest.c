@@ -0,0 +1,613 @@
+/**
+ *  @brief     Host tests of the BQ25895 library against simulated chargers on a virtual clock.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ *
+ *  gcc -std=c11 -O2 -c -IHost -IInclude Source/BQ25895*.c Host/BQ25895_LinuxI2C.c Host/BQ25895_Sim.c
+ *  gcc -std=c11 -O2 -IHost -IInclude Host/BQ25895_HostTest.c BQ25895*.o -o bq25895_test
+ *  ./bq25895_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_Allocator.h"
+#include "BQ25895_ChargeManager.h"
+#include "BQ25895_Config.h"
+#include "BQ25895_FaultLog.h"
+#include "BQ25895_InputOptimizer.h"
+#include "BQ25895_NTC.h"
+#include "BQ25895_OTG.h"
+#include "BQ25895_Sim.h"
+
+#define TEST_CHECK(cond)                                                                            \
+    do {                                                                                            \
+        if (!(cond)) {                                                                              \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                         \
+            test_failures++;                                                                        \
+        }                                                                                           \
+    } while (0)
+
+#define TEST_MUX_ADDR                   (0x70 << 1)
+#define TEST_FLASH_PAGE                 64      /* 4 records per page */
+#define TEST_FLASH_PAGES                2
+
+static int test_failures;
+static uint32_t test_tick = 1;
+static BQ25895_SIM test_sim;
+static I2C_HandleTypeDef test_i2c;
+
+/**
+ * @brief Virtual clock, overrides the monotonic clock of BQ25895_LinuxI2C.c so control loops run at full speed.
+ */
+uint32_t HAL_GetTick(void) {
+    return test_tick;
+}
+
+/*------------------------------------ BUS ------------------------------------------------------*/
+static void Test_BusBatching(void) {
+    BQ25895_BUS bus;
+    BQ25895_BUS_DEVICE device = { 0 };
+    BQ25895_BUS_REQUEST req[4];
+    BQ25895_BUS_STATS stats;
+    uint8_t fault[2];
+    uint8_t vindpm;
+    uint8_t reg[2] = { 0x11, 0x22 };
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    test_sim.chips[0].regs[BQ25895_REG_0B] = 0xA5;
+    BQ25895_BusInit(&bus, &test_i2c, 400000);
+    device.bus = &bus;
+    device.addr = BQ25895_I2C_ADDR;
+
+    /* A fault read and an adjacent control read of one device share one transfer */
+    req[0] = (BQ25895_BUS_REQUEST) { .device = &device, .dir = BQ25895_BUS_READ, .priority = BQ25895_BUS_FAULT,
+        .reg = BQ25895_REG_0B, .data = fault, .len = 2 };
+    req[1] = (BQ25895_BUS_REQUEST) { .device = &device, .dir = BQ25895_BUS_READ, .priority = BQ25895_BUS_CONTROL,
+        .reg = BQ25895_REG_0D, .data = &vindpm, .len = 1 };
+    BQ25895_BusSubmit(&req[0]);
+    BQ25895_BusSubmit(&req[1]);
+    TEST_CHECK(BQ25895_BusService(&bus) == HAL_OK);
+    TEST_CHECK(req[0].done && req[1].done);
+    TEST_CHECK(fault[0] == 0xA5 && vindpm == 0x12);
+
+    /* Touching writes are merged, overlapping ones are not so no register is written twice */
+    req[2] = (BQ25895_BUS_REQUEST) { .device = &device, .dir = BQ25895_BUS_WRITE, .priority = BQ25895_BUS_CONTROL,
+        .reg = BQ25895_REG_04, .data = &reg[0], .len = 1 };
+    req[3] = (BQ25895_BUS_REQUEST) { .device = &device, .dir = BQ25895_BUS_WRITE, .priority = BQ25895_BUS_CONTROL,
+        .reg = BQ25895_REG_05, .data = &reg[1], .len = 1 };
+    BQ25895_BusSubmit(&req[2]);
+    BQ25895_BusSubmit(&req[3]);
+    TEST_CHECK(BQ25895_BusService(&bus) == HAL_OK);
+    TEST_CHECK(req[2].done && req[3].done);
+    TEST_CHECK(test_sim.chips[0].regs[BQ25895_REG_04] == 0x11 && test_sim.chips[0].regs[BQ25895_REG_05] == 0x22);
+
+    BQ25895_BusGetStats(&bus, &stats);
+    TEST_CHECK(stats.requests == 4);
+    TEST_CHECK(stats.transactions == 2);
+    TEST_CHECK(test_sim.transfers == 2);
+}
+
+static void Test_BusPreempted(void) {
+    BQ25895_BUS bus;
+    BQ25895_BUS_DEVICE device = { 0 };
+    uint8_t data;
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_BusInit(&bus, &test_i2c, 400000);
+    device.bus = &bus;
+    device.addr = BQ25895_I2C_ADDR;
+
+    /* An interrupt finding the bus mid transfer gets HAL_BUSY instead of spinning, its request is withdrawn */
+    bus.busy = 1;
+    TEST_CHECK(BQ25895_DeviceRead(&device, BQ25895_REG_04, &data, 1) == HAL_BUSY);
+    TEST_CHECK(bus.head[BQ25895_BUS_CONTROL] == NULL && bus.tail[BQ25895_BUS_CONTROL] == NULL);
+    bus.busy = 0;
+    TEST_CHECK(BQ25895_DeviceRead(&device, BQ25895_REG_04, &data, 1) == HAL_OK);
+    TEST_CHECK(test_sim.transfers == 1);
+}
+
+static void Test_BusMux(void) {
+    BQ25895_BUS bus;
+    BQ25895_BUS_MUX mux;
+    BQ25895_BUS_DEVICE device[2] = { 0 };
+    BQ25895_BUS_STATS stats;
+    uint8_t data;
+    uint8_t i;
+
+    BQ25895_SimInit(&test_sim, &test_i2c, TEST_MUX_ADDR);
+    test_sim.chips[2].regs[BQ25895_REG_04] = 0x02;
+    test_sim.chips[5].regs[BQ25895_REG_04] = 0x05;
+    BQ25895_BusInit(&bus, &test_i2c, 400000);
+    BQ25895_BusMuxInit(&mux, TEST_MUX_ADDR);
+    for (i = 0; i < 2; i++) {
+        device[i].bus = &bus;
+        device[i].addr = BQ25895_I2C_ADDR;
+        device[i].mux = &mux;
+    }
+    device[0].channel = 2;
+    device[1].channel = 5;
+
+    /* Chargers sharing one address are told apart by the channel, a repeated channel is not selected again */
+    TEST_CHECK(BQ25895_DeviceRead(&device[0], BQ25895_REG_04, &data, 1) == HAL_OK && data == 0x02);
+    TEST_CHECK(BQ25895_DeviceRead(&device[0], BQ25895_REG_04, &data, 1) == HAL_OK && data == 0x02);
+    TEST_CHECK(BQ25895_DeviceRead(&device[1], BQ25895_REG_04, &data, 1) == HAL_OK && data == 0x05);
+    TEST_CHECK(BQ25895_DeviceRead(&device[0], BQ25895_REG_04, &data, 1) == HAL_OK && data == 0x02);
+    TEST_CHECK(test_sim.mux_writes == 3);
+
+    BQ25895_BusGetStats(&bus, &stats);
+    TEST_CHECK(stats.mux_selects == 3);
+    TEST_CHECK(stats.transactions == 4);
+
+    /* A lost channel select is redone on the next access */
+    mux.selected = BQ25895_BUS_MUX_NONE;
+    TEST_CHECK(BQ25895_DeviceRead(&device[0], BQ25895_REG_04, &data, 1) == HAL_OK && data == 0x02);
+    TEST_CHECK(test_sim.mux_writes == 4);
+}
+
+/*------------------------------------ CHARGE MANAGER -------------------------------------------*/
+static void Test_ChargeManager(void) {
+    BQ25895_CHARGE_MANAGER cm;
+    uint8_t *regs = test_sim.chips[0].regs;
+    uint32_t transfers;
+    uint32_t step;
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    BQ25895_SelectDevice(NULL);
+    regs[BQ25895_REG_0B] = (BQ25895_USB_DCP << BQ25895_VBUS_STAT_BIT) | BQ25895_PG_STAT_MASK;
+    regs[BQ25895_REG_09] |= BQ25895_BATFET_DIS_MASK;
+    BQ25895_ChargeManagerInit(&cm, NULL);
+
+    /* Every step is at most one bus transaction, FORCE_ICO included */
+    for (step = 0; step < 40; step++) {
+        transfers = test_sim.transfers;
+        TEST_CHECK(BQ25895_ChargeManagerStep(&cm) == HAL_OK);
+        TEST_CHECK(test_sim.transfers - transfers <= 1);
+        test_tick += 50;
+    }
+    TEST_CHECK(regs[BQ25895_REG_14] & BQ25895_ICO_OPTIMIZED_MASK);
+    TEST_CHECK(cm.state != BQ25895_CM_ICO && cm.updates.count == 0);
+    /* The write was based on the register read back, other fields of REG_09 survive */
+    TEST_CHECK(regs[BQ25895_REG_09] & BQ25895_BATFET_DIS_MASK);
+}
+
+/*------------------------------------ ALLOCATOR ------------------------------------------------*/
+static uint32_t Test_AllocatedSum(const BQ25895_ALLOC_CHARGER *chargers, uint8_t count) {
+    uint32_t sum = 0;
+    uint8_t i;
+    for (i = 0; i < count; i++)
+        sum += chargers[i].target_ma;
+    return sum;
+}
+
+static void Test_Allocator(void) {
+    BQ25895_ALLOC_CONFIG config = {
+        .budget_ma = 500,
+        .min_ma = BQ25895_ALLOC_MIN_MA,
+        .idle_ma = BQ25895_ALLOC_IDLE_MA,
+        .headroom_ma = BQ25895_ALLOC_HEADROOM_MA,
+        .probe_ma = BQ25895_ALLOC_PROBE_MA,
+        .deadband_ma = BQ25895_ALLOC_DEADBAND_MA,
+        .efficiency_pct = BQ25895_ALLOC_EFFICIENCY_PCT
+    };
+    BQ25895_ALLOC_CHARGER bays[8];
+    uint8_t *regs = test_sim.chips[0].regs;
+    uint8_t i;
+
+    for (i = 0; i < 8; i++)
+        bays[i] = (BQ25895_ALLOC_CHARGER) { .chrg_stat = BQ25895_FAST_CHARGE, .ichgr_ma = 2000, .vbat_mv = 3800,
+            .vbus_mv = 5000, .iinlim_ma = 500, .max_ma = 3000 };
+
+    /* Floors scaled down to a small budget never add up to more than the budget */
+    for (i = 1; i <= 5; i++) {
+        TEST_CHECK(BQ25895_AllocatorRun(&config, bays, i) == HAL_OK);
+        TEST_CHECK(Test_AllocatedSum(bays, i) <= config.budget_ma);
+        TEST_CHECK(bays[i - 1].target_ma >= BQ25895_IINLIM_BASE);
+    }
+    /* With less than 100mA per bay the budget is refused instead of over committed */
+    TEST_CHECK(BQ25895_AllocatorRun(&config, bays, 8) == HAL_ERROR);
+    TEST_CHECK(BQ25895_AllocatorNext(bays, 8) == BQ25895_ALLOC_NONE);
+    config.budget_ma = 1300;
+    TEST_CHECK(BQ25895_AllocatorRun(&config, bays, 8) == HAL_OK);
+    TEST_CHECK(Test_AllocatedSum(bays, 8) <= config.budget_ma);
+
+    /* A limit the chip raised itself after input detection is written back down */
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    config.budget_ma = 1000;
+    bays[0].iinlim_ma = 500;
+    TEST_CHECK(BQ25895_AllocatorRun(&config, bays, 1) == HAL_OK);
+    TEST_CHECK(BQ25895_AllocatorApply(&bays[0]) == HAL_OK);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) == bays[0].target_ma);
+    regs[BQ25895_REG_00] = BQ25895_SET_FIELD(regs[BQ25895_REG_00], IINLIM, 63);
+    bays[0].iinlim_ma = BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM);
+    TEST_CHECK(BQ25895_AllocatorRun(&config, bays, 1) == HAL_OK);
+    TEST_CHECK(BQ25895_AllocatorNext(bays, 1) == 0);
+    TEST_CHECK(BQ25895_AllocatorApply(&bays[0]) == HAL_OK);
+    TEST_CHECK((uint32_t) BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) <= config.budget_ma);
+}
+
+/*------------------------------------ CONFIG ---------------------------------------------------*/
+/**
+ * @brief Reference CRC-32 as zlib.crc32, which Tools/config_blob.py uses.
+ */
+static uint32_t Test_CRC32(const uint8_t *data, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    uint8_t bit;
+    while (len--) {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return ~crc;
+}
+
+static void Test_Config(void) {
+    uint8_t blob[BQ25895_CONFIG_SIZE(3)] = { 'B', 'Q', 'C', 'F', BQ25895_CONFIG_VERSION, BQ25895_REG_04, 3, 0,
+        0xFF, 0xFF, 0x0F,               /* REG_04, REG_05 whole, REG_06 low nibble */
+        0x10, 0x22, 0x03 };
+    static const uint8_t commands[3][2] = {
+        { BQ25895_REG_02, BQ25895_FORCE_DPDM_MASK },
+        { BQ25895_REG_03, BQ25895_WDT_RESET_MASK },
+        { BQ25895_REG_09, BQ25895_BATFET_DIS_MASK }
+    };
+    uint32_t crc = Test_CRC32(blob, sizeof(blob) - BQ25895_CONFIG_CRC_LEN);
+    uint32_t writes;
+    uint8_t i;
+    uint8_t j;
+
+    TEST_CHECK(Test_CRC32((const uint8_t *) "123456789", 9) == 0xCBF43926);
+    for (i = 0; i < BQ25895_CONFIG_CRC_LEN; i++)
+        blob[sizeof(blob) - BQ25895_CONFIG_CRC_LEN + i] = (uint8_t) (crc >> (8 * i));
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    TEST_CHECK(BQ25895_ConfigCheck(blob, sizeof(blob)) == HAL_OK);
+    TEST_CHECK(BQ25895_ConfigCheck(blob, sizeof(blob) - 1) == HAL_ERROR);
+    TEST_CHECK(BQ25895_ConfigApply(blob, sizeof(blob)) == HAL_OK);
+    TEST_CHECK(test_sim.chips[0].regs[BQ25895_REG_04] == 0x10);
+    TEST_CHECK(test_sim.chips[0].regs[BQ25895_REG_05] == 0x22);
+    TEST_CHECK(test_sim.chips[0].regs[BQ25895_REG_06] == 0x53);
+
+    /* Any flipped bit fails the CRC and nothing is written */
+    writes = test_sim.chips[0].writes;
+    for (i = 0; i < sizeof(blob); i++) {
+        blob[i] ^= 0x01;
+        TEST_CHECK(BQ25895_ConfigApply(blob, sizeof(blob)) == HAL_ERROR);
+        blob[i] ^= 0x01;
+    }
+    TEST_CHECK(test_sim.chips[0].writes == writes);
+
+    /* A valid CRC does not make a command bit configuration */
+    for (i = 0; i < 3; i++) {
+        uint8_t cmd[BQ25895_CONFIG_SIZE(1)] = { 'B', 'Q', 'C', 'F', BQ25895_CONFIG_VERSION, commands[i][0], 1, 0,
+            commands[i][1], commands[i][1] };
+        crc = Test_CRC32(cmd, sizeof(cmd) - BQ25895_CONFIG_CRC_LEN);
+        for (j = 0; j < BQ25895_CONFIG_CRC_LEN; j++)
+            cmd[sizeof(cmd) - BQ25895_CONFIG_CRC_LEN + j] = (uint8_t) (crc >> (8 * j));
+        TEST_CHECK(BQ25895_ConfigCheck(cmd, sizeof(cmd)) == HAL_ERROR);
+        TEST_CHECK(BQ25895_ConfigApply(cmd, sizeof(cmd)) == HAL_ERROR);
+    }
+    TEST_CHECK(test_sim.chips[0].writes == writes);
+}
+
+/*------------------------------------ FAULT LOG ------------------------------------------------*/
+static uint8_t test_flash[TEST_FLASH_PAGE * TEST_FLASH_PAGES];
+static uint32_t test_flash_erases;
+static uint32_t test_fault_callbacks;
+
+/**
+ * @brief Application override of the weak callback, it links and runs next to the fault history.
+ */
+void BQ25895_FaultCallback(const BQ25895_BUS_DEVICE *device, uint8_t fault) {
+    (void) device;
+    (void) fault;
+    test_fault_callbacks++;
+}
+
+static HAL_StatusTypeDef Test_FlashErase(uintptr_t page) {
+    memset((void *) page, 0xFF, TEST_FLASH_PAGE);
+    test_flash_erases++;
+    return HAL_OK;
+}
+
+/* NOR flash can only clear bits */
+static HAL_StatusTypeDef Test_FlashProgram(uintptr_t addr, const uint8_t *data, uint32_t len) {
+    uint8_t *dst = (uint8_t *) addr;
+    uint32_t i;
+    for (i = 0; i < len; i++)
+        dst[i] &= data[i];
+    return HAL_OK;
+}
+
+static void Test_FlashInit(BQ25895_FAULT_FLASH *flash) {
+    *flash = (BQ25895_FAULT_FLASH) {
+        .base = (uintptr_t) test_flash,
+        .page_size = TEST_FLASH_PAGE,
+        .pages = TEST_FLASH_PAGES,
+        .erase = Test_FlashErase,
+        .program = Test_FlashProgram
+    };
+}
+
+static void Test_FaultFlashMount(void) {
+    BQ25895_FAULT_FLASH flash;
+    BQ25895_FAULT_FLASH remount;
+    BQ25895_FAULT_EVENT events[10];
+    BQ25895_FAULT_EVENT event;
+    uint8_t i;
+
+    memset(test_flash, 0xFF, sizeof(test_flash));
+    for (i = 0; i < 10; i++)
+        events[i] = (BQ25895_FAULT_EVENT) { .tick = 1000u * i, .device = 1, .fault = (uint8_t) (i + 1) };
+
+    /* Blank flash mounts empty */
+    Test_FlashInit(&flash);
+    TEST_CHECK(BQ25895_FaultFlashMount(&flash) == HAL_OK);
+    TEST_CHECK(flash.offset == 0 && flash.seq == 0);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 0, &event) == HAL_ERROR);
+
+    /* A remount after a reset continues behind the newest record */
+    TEST_CHECK(BQ25895_FaultFlashWrite(&flash, events, 6) == HAL_OK);
+    Test_FlashInit(&remount);
+    TEST_CHECK(BQ25895_FaultFlashMount(&remount) == HAL_OK);
+    TEST_CHECK(remount.seq == 6 && remount.offset == 6 * BQ25895_FAULT_RECORD_LEN);
+    TEST_CHECK(BQ25895_FaultFlashRead(&remount, 0, &event) == HAL_OK && event.fault == 6);
+    TEST_CHECK(BQ25895_FaultFlashRead(&remount, 5, &event) == HAL_OK && event.fault == 1);
+
+    /* Wrapping erases the oldest page, one page of history survives */
+    TEST_CHECK(BQ25895_FaultFlashWrite(&remount, &events[6], 4) == HAL_OK);
+    Test_FlashInit(&flash);
+    TEST_CHECK(BQ25895_FaultFlashMount(&flash) == HAL_OK);
+    TEST_CHECK(flash.seq == 10 && flash.offset == 2 * BQ25895_FAULT_RECORD_LEN);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 0, &event) == HAL_OK && event.fault == 10);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 5, &event) == HAL_OK && event.fault == 5);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 6, &event) == HAL_ERROR);
+    TEST_CHECK(test_flash_erases == 3);
+
+    /* A record torn by a power loss is skipped, writing resumes behind it */
+    test_flash[2 * BQ25895_FAULT_RECORD_LEN] = 0x00;
+    Test_FlashInit(&flash);
+    TEST_CHECK(BQ25895_FaultFlashMount(&flash) == HAL_OK);
+    TEST_CHECK(flash.seq == 10 && flash.offset == 3 * BQ25895_FAULT_RECORD_LEN);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 0, &event) == HAL_OK && event.fault == 10);
+}
+
+static void Test_FaultLogRead(void) {
+    static BQ25895_FAULT_LOG log;
+    BQ25895_FAULT_FLASH flash;
+    BQ25895_FAULT_BACKEND backend = { BQ25895_FaultFlashWrite, &flash };
+    BQ25895_FAULT_EVENT event;
+    uint8_t fault;
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    memset(test_flash, 0xFF, sizeof(test_flash));
+    Test_FlashInit(&flash);
+    TEST_CHECK(BQ25895_FaultFlashMount(&flash) == HAL_OK);
+    TEST_CHECK(BQ25895_FaultLogInit(&log, BQ25895_GetSelectedDevice(), 3, &backend) == HAL_OK);
+    test_fault_callbacks = 0;
+
+    /* Every REG_0C read feeds the history, only changes are recorded */
+    test_sim.chips[0].fault_latch = BQ25895_FAULT_BAT_MASK;
+    test_tick = 5000;
+    TEST_CHECK(BQ25895_ReadRegister(BQ25895_REG_0C, &fault) == HAL_OK && fault == BQ25895_FAULT_BAT_MASK);
+    test_tick = 5100;
+    TEST_CHECK(BQ25895_ReadRegister(BQ25895_REG_0C, &fault) == HAL_OK && fault == 0);
+    TEST_CHECK(BQ25895_ReadRegister(BQ25895_REG_0C, &fault) == HAL_OK && fault == 0);
+    TEST_CHECK(log.total == 2);
+    TEST_CHECK(test_fault_callbacks == 3);
+    TEST_CHECK(BQ25895_FaultLogGet(&log, 1, &event) == HAL_OK && event.fault == BQ25895_FAULT_BAT_MASK
+            && event.tick == 5000 && event.device == 3);
+
+    /* Nothing is due before a batch fills or the flush time passes, force writes everything */
+    TEST_CHECK(BQ25895_FaultLogService(&log, 0) == HAL_OK && log.saved == 0);
+    TEST_CHECK(BQ25895_FaultLogService(&log, 1) == HAL_OK && log.saved == 2);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 0, &event) == HAL_OK && event.fault == 0);
+    TEST_CHECK(BQ25895_FaultFlashRead(&flash, 1, &event) == HAL_OK && event.fault == BQ25895_FAULT_BAT_MASK);
+}
+
+/*------------------------------------ INPUT OPTIMIZER ------------------------------------------*/
+typedef struct TEST_ADAPTER {
+    uint16_t open_mv;               /**< VBUS without load */
+    uint16_t limit_ma;              /**< Current above which the adapter collapses to VINDPM */
+    uint16_t demand_ma;             /**< Input current the charger would draw without IINLIM */
+    uint16_t ichg_cap_ma;           /**< Charge current limit independent of the input, e.g. thermal */
+} TEST_ADAPTER;
+
+/**
+ * @brief Adapter with 100mOhm output resistance feeding a buck charger at 80% of the input current.
+ */
+static void Test_AdapterModel(BQ25895_SIM_CHIP *chip) {
+    const TEST_ADAPTER *adapter = (const TEST_ADAPTER *) chip->context;
+    uint32_t iinlim = BQ25895_DECODE(chip->regs[BQ25895_REG_00], IINLIM);
+    uint32_t vindpm = BQ25895_DECODE(chip->regs[BQ25895_REG_0D], VINDPM);
+    uint32_t input = (iinlim < adapter->demand_ma) ? iinlim : adapter->demand_ma;
+    uint8_t idpm = iinlim < adapter->demand_ma;
+    uint8_t vdpm = 0;
+    uint32_t vbus;
+    uint32_t ichg;
+
+    if (input > adapter->limit_ma) {
+        input = adapter->limit_ma;
+        vbus = vindpm;
+        vdpm = 1;
+        idpm = 0;
+    } else {
+        vbus = adapter->open_mv - input / 10;
+    }
+    ichg = input * 5 / 4;
+    if (ichg > adapter->ichg_cap_ma)
+        ichg = adapter->ichg_cap_ma;
+    chip->regs[BQ25895_REG_11] = BQ25895_VBUS_GD_MASK | BQ25895_ENCODE(vbus, VBUSV);
+    chip->regs[BQ25895_REG_12] = BQ25895_ENCODE(ichg, ICHGR);
+    chip->regs[BQ25895_REG_13] = (vdpm << BQ25895_VDPM_STAT_BIT) | (idpm << BQ25895_IDPM_STAT_BIT);
+}
+
+static void Test_RunOptimizer(BQ25895_INPUT_OPTIMIZER *opt, uint32_t ms) {
+    while (ms--) {
+        test_tick++;
+        TEST_CHECK(BQ25895_InputOptimizerStep(opt) == HAL_OK);
+    }
+}
+
+static void Test_InputOptimizer(void) {
+    static TEST_ADAPTER adapter;
+    BQ25895_INPUT_OPTIMIZER opt;
+    uint8_t *regs = test_sim.chips[0].regs;
+
+    /* Weak adapter: IINLIM climbs to just below the collapse point and stays there */
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    adapter = (TEST_ADAPTER) { .open_mv = 5000, .limit_ma = 1800, .demand_ma = 2400, .ichg_cap_ma = 5000 };
+    test_sim.chips[0].model = Test_AdapterModel;
+    test_sim.chips[0].context = &adapter;
+    regs[BQ25895_REG_00] |= BQ25895_ENILIM_MASK;
+    TEST_CHECK(BQ25895_InputOptimizerStart(&opt, NULL) == HAL_OK);
+    TEST_CHECK(regs[BQ25895_REG_0D] & BQ25895_FORCE_VINDPM_MASK);
+    Test_RunOptimizer(&opt, 20000);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) <= 1800);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) >= 1800 - 2 * BQ25895_IO_IINLIM_STEP_MA);
+    TEST_CHECK(opt.ceiling_ma <= 1800);
+    /* Field updates leave the other bits alone */
+    TEST_CHECK(regs[BQ25895_REG_0D] & BQ25895_FORCE_VINDPM_MASK);
+    TEST_CHECK(regs[BQ25895_REG_00] & BQ25895_ENILIM_MASK);
+
+    /* Strong adapter, light load: IINLIM covers the demand and VINDPM follows the open VBUS */
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    adapter = (TEST_ADAPTER) { .open_mv = 5200, .limit_ma = 3000, .demand_ma = 1200, .ichg_cap_ma = 5000 };
+    test_sim.chips[0].model = Test_AdapterModel;
+    test_sim.chips[0].context = &adapter;
+    TEST_CHECK(BQ25895_InputOptimizerStart(&opt, NULL) == HAL_OK);
+    Test_RunOptimizer(&opt, 20000);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) >= 1200);
+    /* VBUS reads 5000mV at 1200mA (5080mV, floored to the VBUSV step) */
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_0D], VINDPM) == 5000 - BQ25895_IO_VINDPM_HEADROOM_MV);
+
+    /* Charge current capped elsewhere: the failed probe sets a ceiling that holds until the re-probe */
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    adapter = (TEST_ADAPTER) { .open_mv = 5000, .limit_ma = 3000, .demand_ma = 2400, .ichg_cap_ma = 1000 };
+    test_sim.chips[0].model = Test_AdapterModel;
+    test_sim.chips[0].context = &adapter;
+    TEST_CHECK(BQ25895_InputOptimizerStart(&opt, NULL) == HAL_OK);
+    Test_RunOptimizer(&opt, 10000);
+    TEST_CHECK(opt.ceiling_ma == 800);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) == 800);
+    Test_RunOptimizer(&opt, 10000);
+    TEST_CHECK(BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM) == 800);
+}
+
+/*------------------------------------ OTG ------------------------------------------------------*/
+typedef struct TEST_BOOST_LOAD {
+    uint16_t load_ma;
+    uint16_t bat_mohm;              /**< Battery plus BATFET resistance */
+} TEST_BOOST_LOAD;
+
+/**
+ * @brief Boost output droops 200mV per A below BOOSTV, battery at 3.8V and 25C. SYSV sags by the battery
+ * current (output power / 90% / 3.8V) times bat_mohm.
+ */
+static void Test_BoostModel(BQ25895_SIM_CHIP *chip) {
+    const TEST_BOOST_LOAD *load = (const TEST_BOOST_LOAD *) chip->context;
+    uint32_t boostv = BQ25895_DECODE(chip->regs[BQ25895_REG_0A], BOOSTV);
+    uint32_t bat_ma = 0;
+
+    chip->regs[BQ25895_REG_0E] = BQ25895_ENCODE(3800, BATV);
+    chip->regs[BQ25895_REG_10] = BQ25895_ENCODE(BQ25895_NTCToPercent(BQ25895_NTC_103AT, 250), TSPCT);
+    chip->regs[BQ25895_REG_11] = 0;
+    if (chip->regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK) {
+        chip->regs[BQ25895_REG_11] = BQ25895_ENCODE(boostv - load->load_ma / 5, VBUSV);
+        bat_ma = (boostv * load->load_ma * 10) / (9 * 3800);
+    }
+    chip->regs[BQ25895_REG_0F] = BQ25895_ENCODE(3800 - bat_ma * load->bat_mohm / 1000, SYSV);
+}
+
+static void Test_RunOTG(BQ25895_OTG_MANAGER *otg, uint32_t ms) {
+    while (ms--) {
+        test_tick++;
+        TEST_CHECK(BQ25895_OTGStep(otg) == HAL_OK);
+    }
+}
+
+static void Test_OTG(void) {
+    static TEST_BOOST_LOAD load;
+    BQ25895_OTG_MANAGER otg;
+    uint8_t *regs = test_sim.chips[0].regs;
+
+    BQ25895_SimInit(&test_sim, &test_i2c, 0);
+    BQ25895_Init(&test_i2c);
+    load.load_ma = 0;
+    load.bat_mohm = 100;
+    test_sim.chips[0].model = Test_BoostModel;
+    test_sim.chips[0].context = &load;
+    /* 4998mV reads as 4900mV at no load, almost a whole VBUSV step below BOOSTV */
+    regs[BQ25895_REG_0A] = BQ25895_SET_FIELD(regs[BQ25895_REG_0A], BOOSTV, 7);
+    TEST_CHECK(BQ25895_OTGStart(&otg, NULL) == HAL_OK);
+    TEST_CHECK(otg.freq == BQ25895_BOOST_FREQ_500K && otg.boostv_mv == 4998);
+
+    BQ25895_OTGRequest(&otg, BQ25895_ENABLED);
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK);
+
+    /* Heavy load alone does not restart a running boost */
+    load.load_ma = 1500;
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(otg.heavy && otg.running);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_500K);
+
+    /* BOOST_FAULT stops boost, it restarts after the back off at the heavy load frequency */
+    test_sim.chips[0].fault_latch = BQ25895_BOOST_FAULT_MASK;
+    Test_RunOTG(&otg, 300);
+    TEST_CHECK(!(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK));
+    TEST_CHECK(otg.faults == 1);
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_1500K);
+
+    /* No load reads one VBUSV step below BOOSTV, after idle_ms boost moves back to the light frequency */
+    load.load_ma = 0;
+    Test_RunOTG(&otg, BQ25895_OTG_IDLE_MS + 1000);
+    TEST_CHECK(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_500K);
+
+    /* A weak battery sags under a load VBUS still regulates, the restart waits for the load to go */
+    load.load_ma = 700;
+    load.bat_mohm = 300;
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(otg.heavy && otg.vbat_rest_mv != 0);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_500K);
+    load.load_ma = 0;
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_1500K);
+    Test_RunOTG(&otg, BQ25895_OTG_IDLE_MS + 1000);
+    TEST_CHECK(BQ25895_GET_FIELD(regs[BQ25895_REG_02], BOOST_FREQ) == BQ25895_BOOST_FREQ_500K);
+
+    BQ25895_OTGRequest(&otg, BQ25895_DISABLED);
+    Test_RunOTG(&otg, 1000);
+    TEST_CHECK(!(regs[BQ25895_REG_03] & BQ25895_OTG_CONFIG_MASK));
+    TEST_CHECK(otg.updates.count == 0);
+}
+
+int main(void) {
+    Test_BusBatching();
+    Test_BusPreempted();
+    Test_BusMux();
+    Test_ChargeManager();
+    Test_Allocator();
+    Test_Config();
+    Test_FaultFlashMount();
+    Test_FaultLogRead();
+    Test_InputOptimizer();
+    Test_OTG();
+    if (test_failures != 0) {
+        printf("%d checks failed\n", test_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ *  @brief     Linux i2c-dev transport behind the host HAL replacement.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "main.h"
+
+#define BQ25895_LINUX_MAX_WRITE         64
+
+/**
+ * @brief Issue one combined I2C_RDWR transaction.
+ * @note addr is the 8 bit (shifted) address the STM32 HAL expects.
+ */
+static HAL_StatusTypeDef BQ25895_Linux_RdWr(I2C_HandleTypeDef *hi2c, struct i2c_msg *msgs, uint32_t count) {
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = count };
+    if (hi2c->fd < 0)
+        return HAL_ERROR;
+    return (ioctl(hi2c->fd, I2C_RDWR, &xfer) == (int) count) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Open an i2c-dev adapter.
+ * @param[out] *hi2c Handle to fill in.
+ * @param[in] *path Adapter, e.g. "/dev/i2c-1".
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ */
+HAL_StatusTypeDef BQ25895_LinuxI2COpen(I2C_HandleTypeDef *hi2c, const char *path) {
+    *hi2c = (I2C_HandleTypeDef) { .fd = open(path, O_RDWR) };
+    return (hi2c->fd >= 0) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Close an adapter opened with BQ25895_LinuxI2COpen().
+ * @param[in,out] *hi2c Handle.
+ */
+void BQ25895_LinuxI2CClose(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->fd >= 0)
+        close(hi2c->fd);
+    hi2c->fd = -1;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    uint8_t buffer[1 + BQ25895_LINUX_MAX_WRITE];
+    struct i2c_msg msg = { .addr = DevAddress >> 1, .flags = 0, .len = Size + 1, .buf = buffer };
+    (void) MemAddSize;
+    (void) Timeout;
+    if (hi2c->transfer != NULL)
+        return hi2c->transfer(hi2c->context, DevAddress, MemAddress, pData, Size, 1);
+    if (Size > BQ25895_LINUX_MAX_WRITE)
+        return HAL_ERROR;
+    buffer[0] = MemAddress;
+    memcpy(&buffer[1], pData, Size);
+    return BQ25895_Linux_RdWr(hi2c, &msg, 1);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    uint8_t reg = MemAddress;
+    struct i2c_msg msgs[2] = {
+        { .addr = DevAddress >> 1, .flags = 0, .len = 1, .buf = &reg },
+        { .addr = DevAddress >> 1, .flags = I2C_M_RD, .len = Size, .buf = pData }
+    };
+    (void) MemAddSize;
+    (void) Timeout;
+    if (hi2c->transfer != NULL)
+        return hi2c->transfer(hi2c->context, DevAddress, MemAddress, pData, Size, 0);
+    return BQ25895_Linux_RdWr(hi2c, msgs, 2);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout) {
+    struct i2c_msg msg = { .addr = DevAddress >> 1, .flags = 0, .len = Size, .buf = pData };
+    (void) Timeout;
+    if (hi2c->transfer != NULL)
+        return (Size != 0) ? hi2c->transfer(hi2c->context, DevAddress, pData[0], pData + 1, Size - 1, 1) : HAL_ERROR;
+    return BQ25895_Linux_RdWr(hi2c, &msg, 1);
+}
+
+/**
+ * @brief Milliseconds since the first call, from the monotonic clock.
+ */
+__weak uint32_t HAL_GetTick(void) {
+    static uint64_t start_ms;
+    struct timespec ts;
+    uint64_t now_ms;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now_ms = (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    if (start_ms == 0)
+        start_ms = now_ms - 1;
+    return (uint32_t) (now_ms - start_ms);
+}
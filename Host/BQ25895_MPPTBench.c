@@ -0,0 +1,199 @@
+/**
+ *  @brief     Tracking efficiency of the BQ25895 MPPT modes on a simulated solar panel.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ *
+ *  gcc -std=c11 -O2 -c -IHost -IInclude Source/BQ25895*.c Host/BQ25895_LinuxI2C.c Host/BQ25895_Sim.c
+ *  gcc -std=c11 -O2 -IHost -IInclude Host/BQ25895_MPPTBench.c BQ25895*.o -lm -o bq25895_mppt
+ *  ./bq25895_mppt [seconds]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_MPPT.h"
+#include "BQ25895_Sim.h"
+
+#define BENCH_PANEL_ISC_MA              1000    /* Short circuit current at full sun */
+#define BENCH_PANEL_VOC_MV              12000   /* Open-circuit voltage at full sun */
+#define BENCH_PANEL_KNEE_MV             600     /* Width of the knee of the I-V curve */
+#define BENCH_CHARGER_EFFICIENCY        0.90
+#define BENCH_VBAT_MV                   3800
+#define BENCH_ICHG_MA                   2048    /* Fast charge current, caps the input power the charger takes */
+
+typedef struct BENCH_PANEL {
+    double sun;                     /**< Irradiance, 1.0 = full sun */
+} BENCH_PANEL;
+
+static uint32_t bench_tick = 1;
+static BQ25895_SIM bench_sim;
+static I2C_HandleTypeDef bench_i2c;
+static BENCH_PANEL bench_panel;
+
+/**
+ * @brief Virtual clock, overrides the monotonic clock of BQ25895_LinuxI2C.c so a day runs in seconds.
+ */
+uint32_t HAL_GetTick(void) {
+    return bench_tick;
+}
+
+/**
+ * @brief Irradiance over the run: morning ramp, a passing cloud and fast broken cloud at the end.
+ */
+static double Bench_Sun(uint32_t ms, uint32_t total_ms) {
+    double t = (double) ms / total_ms;
+    if (t < 0.3)
+        return 0.2 + 0.8 * t / 0.3;
+    if (t > 0.45 && t < 0.5)
+        return 0.3;
+    if (t > 0.7)
+        return ((ms / 5000) % 2) ? 0.6 : 1.0;
+    return 1.0;
+}
+
+static double Bench_PanelVoc(const BENCH_PANEL *panel) {
+    return (panel->sun > 0.01) ? BENCH_PANEL_VOC_MV + 500.0 * log(panel->sun) : 0;
+}
+
+/**
+ * @brief Panel current in mA at a terminal voltage, exponential knee towards Voc.
+ */
+static double Bench_PanelCurrent(const BENCH_PANEL *panel, double mv) {
+    double ma = BENCH_PANEL_ISC_MA * panel->sun * (1.0 - exp((mv - Bench_PanelVoc(panel)) / BENCH_PANEL_KNEE_MV));
+    return (ma > 0) ? ma : 0;
+}
+
+/**
+ * @brief Largest power the panel can deliver, for the tracking efficiency.
+ */
+static double Bench_PanelMaxPower(const BENCH_PANEL *panel) {
+    double best = 0;
+    double mv;
+    for (mv = 0; mv < Bench_PanelVoc(panel); mv += 10) {
+        if (mv * Bench_PanelCurrent(panel, mv) > best)
+            best = mv * Bench_PanelCurrent(panel, mv);
+    }
+    return best / 1e6;
+}
+
+/**
+ * @brief Operating point of panel and charger: the charger takes the power it needs for ICHG up to IINLIM,
+ * and holds VBUS at VINDPM once the panel cannot deliver that. EN_HIZ opens the input.
+ */
+static void Bench_OperatingPoint(const uint8_t *regs, const BENCH_PANEL *panel, double *mv, double *ma) {
+    double vindpm = BQ25895_DECODE(regs[BQ25895_REG_0D], VINDPM);
+    double iinlim = BQ25895_DECODE(regs[BQ25895_REG_00], IINLIM);
+    double voc = Bench_PanelVoc(panel);
+    double demand_mw = (double) BENCH_VBAT_MV * BENCH_ICHG_MA / 1000.0 / BENCH_CHARGER_EFFICIENCY;
+    double lo;
+    double hi;
+    double demand;
+    uint8_t i;
+
+    *mv = voc;
+    *ma = 0;
+    if ((regs[BQ25895_REG_00] & BQ25895_ENHIZ_MASK) || vindpm >= voc)
+        return;
+    demand = fmin(iinlim, demand_mw * 1000.0 / vindpm);
+    if (Bench_PanelCurrent(panel, vindpm) <= demand) {
+        *mv = vindpm;
+        *ma = Bench_PanelCurrent(panel, vindpm);
+        return;
+    }
+    /* The panel has more to give than the charger takes, it settles above VINDPM */
+    lo = vindpm;
+    hi = voc;
+    for (i = 0; i < 40; i++) {
+        *mv = (lo + hi) / 2;
+        demand = fmin(iinlim, demand_mw * 1000.0 / *mv);
+        if (Bench_PanelCurrent(panel, *mv) > demand)
+            lo = *mv;
+        else
+            hi = *mv;
+    }
+    *ma = Bench_PanelCurrent(panel, *mv);
+}
+
+static void Bench_PanelModel(BQ25895_SIM_CHIP *chip) {
+    double mv;
+    double ma;
+    double ichg;
+
+    Bench_OperatingPoint(chip->regs, (const BENCH_PANEL *) chip->context, &mv, &ma);
+    ichg = mv * ma * BENCH_CHARGER_EFFICIENCY / BENCH_VBAT_MV;
+    if (mv > 15300)
+        mv = 15300;
+    chip->regs[BQ25895_REG_0E] = BQ25895_ENCODE(BENCH_VBAT_MV, BATV);
+    chip->regs[BQ25895_REG_11] = BQ25895_VBUS_GD_MASK | ((mv >= 2600) ? BQ25895_ENCODE((uint32_t) mv, VBUSV) : 0);
+    chip->regs[BQ25895_REG_12] = BQ25895_ENCODE((uint32_t) fmin(ichg, 6350), ICHGR);
+}
+
+/**
+ * @brief Run the panel for total_ms with or without MPPT and report energy and bus traffic.
+ */
+static void Bench_Run(const char *name, const BQ25895_MPPT_CONFIG *config, uint8_t track, uint32_t total_ms) {
+    BQ25895_MPPT mppt;
+    double harvested = 0;
+    double available = 0;
+    double mv;
+    double ma;
+    uint32_t ms;
+    uint8_t iinlim = BQ25895_ENCODE(3250, IINLIM);
+
+    BQ25895_SimInit(&bench_sim, &bench_i2c, 0);
+    bench_sim.chips[0].model = Bench_PanelModel;
+    bench_sim.chips[0].context = &bench_panel;
+    BQ25895_Init(&bench_i2c);
+    BQ25895_UpdateBits(BQ25895_REG_00, BQ25895_IINLIM_MASK, &iinlim);
+    bench_panel.sun = Bench_Sun(0, total_ms);
+    if (track && BQ25895_MPPTStart(&mppt, config) != HAL_OK) {
+        printf("%-22s start failed\n", name);
+        return;
+    }
+
+    for (ms = 0; ms < total_ms; ms++) {
+        bench_tick++;
+        bench_panel.sun = Bench_Sun(ms, total_ms);
+        if (track)
+            BQ25895_MPPTStep(&mppt);
+        Bench_OperatingPoint(bench_sim.chips[0].regs, &bench_panel, &mv, &ma);
+        harvested += mv * ma / 1e6 / 3600000.0;
+        if (ms % 100 == 0)
+            available += Bench_PanelMaxPower(&bench_panel) * 100 / 3600000.0;
+    }
+    printf("%-22s %8.3f Wh of %8.3f Wh  %5.1f%%  %6u reads %6u writes\n", name, harvested, available,
+            100.0 * harvested / available, (unsigned) bench_sim.chips[0].reads, (unsigned) bench_sim.chips[0].writes);
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = (argc > 1) ? (uint32_t) atoi(argv[1]) : 1800;
+    BQ25895_MPPT_CONFIG po = {
+        .mode = BQ25895_MPPT_PERTURB_OBSERVE,
+        .step_mv = BQ25895_MPPT_STEP_MV,
+        .period_ms = BQ25895_MPPT_PERIOD_MS,
+        .vindpm_min_mv = BQ25895_MPPT_VINDPM_MIN_MV,
+        .vindpm_max_mv = BQ25895_MPPT_VINDPM_MAX_MV,
+        .voc_ratio_q8 = BQ25895_MPPT_VOC_RATIO_Q8,
+        .voc_interval_ms = BQ25895_MPPT_VOC_INTERVAL_MS,
+        .voc_settle_ms = BQ25895_MPPT_VOC_SETTLE_MS
+    };
+    BQ25895_MPPT_CONFIG focv = po;
+    BQ25895_MPPT_CONFIG po_fast = po;
+
+    if (seconds == 0)
+        seconds = 1800;
+    focv.mode = BQ25895_MPPT_FRACTIONAL_VOC;
+    focv.voc_interval_ms = 10000;
+    po_fast.period_ms = 100;
+
+    printf("%u s of simulated sun, %d mA / %d mV panel\n", (unsigned) seconds, BENCH_PANEL_ISC_MA, BENCH_PANEL_VOC_MV);
+    Bench_Run("fixed VINDPM 4.4V", NULL, 0, seconds * 1000);
+    Bench_Run("perturb and observe", &po, 1, seconds * 1000);
+    Bench_Run("P&O, 100ms period", &po_fast, 1, seconds * 1000);
+    Bench_Run("fractional Voc, 10s", &focv, 1, seconds * 1000);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ *  @brief     Simulated BQ25895 register files behind an optional mux for host tests and evaluations.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include "main.h"
+#include "BQ25895_Sim.h"
+
+/* Power on defaults of REG_00..REG_14, status and ADC registers read as 0 until a model fills them */
+static const uint8_t BQ25895_sim_defaults[BQ25895_REG_COUNT] = {
+    0x08, 0x06, 0x3D, 0x3A, 0x20, 0x13, 0x5E, 0x9D, 0x00, 0x44, 0x93,
+    0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39
+};
+
+/**
+ * @brief Charger the transfer is addressed to, NULL if nobody acknowledges it.
+ */
+static BQ25895_SIM_CHIP *BQ25895_Sim_Chip(BQ25895_SIM *sim, uint16_t addr) {
+    uint8_t channel;
+    if (addr != BQ25895_I2C_ADDR)
+        return NULL;
+    if (sim->mux_addr == 0)
+        return &sim->chips[0];
+    /* With more than one channel open the chargers would answer at once, treat it as a bus error */
+    for (channel = 0; channel < BQ25895_SIM_CHANNELS; channel++) {
+        if (sim->mux_mask == (1 << channel))
+            return &sim->chips[channel];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Self clearing command bits finish immediately.
+ */
+static void BQ25895_Sim_Commands(BQ25895_SIM_CHIP *chip) {
+    chip->regs[BQ25895_REG_02] &= ~BQ25895_CONV_START_MASK;
+    if (chip->regs[BQ25895_REG_14] & BQ25895_RESET_MASK) {
+        memcpy(chip->regs, BQ25895_sim_defaults, BQ25895_REG_0B);
+        chip->regs[BQ25895_REG_0D] = BQ25895_sim_defaults[BQ25895_REG_0D];
+        chip->regs[BQ25895_REG_14] &= ~BQ25895_RESET_MASK;
+    }
+    if (chip->regs[BQ25895_REG_09] & BQ25895_FORCE_ICO_MASK) {
+        chip->regs[BQ25895_REG_09] &= ~BQ25895_FORCE_ICO_MASK;
+        chip->regs[BQ25895_REG_14] |= BQ25895_ICO_OPTIMIZED_MASK;
+    }
+}
+
+/**
+ * @brief Reset the simulated chargers to their power on defaults and route an I2C handle to them.
+ * @param[out] *sim Simulator instance.
+ * @param[out] *i2c Handle to route, use it for BQ25895_Init() or BQ25895_BusInit().
+ * @param[in] mux_addr 8 bit address of a TCA9548 style mux with one charger per channel, 0 for a single
+ * charger directly on the bus.
+ */
+void BQ25895_SimInit(BQ25895_SIM *sim, I2C_HandleTypeDef *i2c, uint16_t mux_addr) {
+    uint8_t channel;
+    memset(sim, 0, sizeof(*sim));
+    sim->mux_addr = mux_addr;
+    for (channel = 0; channel < BQ25895_SIM_CHANNELS; channel++)
+        memcpy(sim->chips[channel].regs, BQ25895_sim_defaults, BQ25895_REG_COUNT);
+    i2c->fd = -1;
+    i2c->transfer = BQ25895_SimTransfer;
+    i2c->context = sim;
+}
+
+/**
+ * @brief I2C_HandleTypeDef transfer hook, context is a BQ25895_SIM.
+ * @note Writes to the status and ADC registers are ignored like on the chip. REG_0C reads return the
+ * present faults plus the latched ones, which clear with the read.
+ */
+HAL_StatusTypeDef BQ25895_SimTransfer(void *context, uint16_t addr, uint8_t reg, uint8_t *data, uint16_t len,
+        uint8_t write) {
+    BQ25895_SIM *sim = (BQ25895_SIM *) context;
+    BQ25895_SIM_CHIP *chip;
+    uint16_t i;
+
+    if (sim->mux_addr != 0 && addr == sim->mux_addr) {
+        if (!write || len != 0)
+            return HAL_ERROR;
+        sim->mux_mask = reg;
+        sim->mux_writes++;
+        return HAL_OK;
+    }
+    chip = BQ25895_Sim_Chip(sim, addr);
+    if (chip == NULL || reg + len > BQ25895_REG_COUNT)
+        return HAL_ERROR;
+    sim->transfers++;
+
+    if (write) {
+        for (i = 0; i < len; i++) {
+            if (reg + i < BQ25895_REG_0B || reg + i == BQ25895_REG_0D || reg + i == BQ25895_REG_14)
+                chip->regs[reg + i] = data[i];
+        }
+        BQ25895_Sim_Commands(chip);
+        chip->writes++;
+        return HAL_OK;
+    }
+
+    if (chip->model != NULL)
+        chip->model(chip);
+    memcpy(data, &chip->regs[reg], len);
+    if (reg <= BQ25895_REG_0C && reg + len > BQ25895_REG_0C) {
+        data[BQ25895_REG_0C - reg] |= chip->fault_latch;
+        chip->fault_latch = 0;
+    }
+    chip->reads++;
+    return HAL_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
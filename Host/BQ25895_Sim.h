@@ -0,0 +1,52 @@
+/**
+ *  @brief     Simulated BQ25895 register files behind an optional mux for host tests and evaluations.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_SIM_H
+#define BQ25895_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_SIM_CHANNELS            8       /* One charger per mux channel */
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_SIM_CHIP BQ25895_SIM_CHIP;
+
+struct BQ25895_SIM_CHIP {
+    uint8_t regs[BQ25895_REG_COUNT];
+    /** Optional plant model, called before every read to refresh the status and ADC registers */
+    void (*model)(BQ25895_SIM_CHIP *chip);
+    void *context;                  /**< Model state */
+    uint8_t fault_latch;            /**< REG_0C bits reported by the next read only, as the chip latches them */
+    uint32_t reads;
+    uint32_t writes;
+};
+
+typedef struct BQ25895_SIM {
+    BQ25895_SIM_CHIP chips[BQ25895_SIM_CHANNELS];
+    uint16_t mux_addr;              /**< 8 bit mux address, 0 for a single charger without a mux */
+    uint8_t mux_mask;               /**< Channel register of the mux */
+    uint32_t transfers;             /**< Register transfers seen on the bus */
+    uint32_t mux_writes;
+} BQ25895_SIM;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_SimInit(BQ25895_SIM *sim, I2C_HandleTypeDef *i2c, uint16_t mux_addr);
+
+HAL_StatusTypeDef BQ25895_SimTransfer(void *context, uint16_t addr, uint8_t reg, uint8_t *data, uint16_t len,
+        uint8_t write);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_SIM_H */
@@ -0,0 +1,171 @@
+/**
+ *  @brief     Charge delivered and temperatures of the BQ25895 thermal governor on a simulated hot device.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ *
+ *  gcc -std=c11 -O2 -c -IHost -IInclude Source/BQ25895*.c Host/BQ25895_LinuxI2C.c Host/BQ25895_Sim.c
+ *  gcc -std=c11 -O2 -IHost -IInclude Host/BQ25895_ThermalBench.c BQ25895*.o -o bq25895_thermal
+ *  ./bq25895_thermal [seconds] [ambient C]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_NTC.h"
+#include "BQ25895_Sim.h"
+#include "BQ25895_ThermalGovernor.h"
+
+#define BENCH_VBAT_MV                   3800
+#define BENCH_BUCK_LOSS                 0.10    /* Switching loss as a fraction of the output power */
+#define BENCH_BUCK_R_OHM                0.10    /* Conduction loss resistance */
+#define BENCH_DIE_RTH                   70.0    /* C/W, die to ambient */
+#define BENCH_DIE_TAU_S                 5.0
+#define BENCH_TREG_C                    120.0   /* TREG default */
+#define BENCH_TREG_BAND_C               10.0    /* Die temperature span over which the chip throttles to 0 */
+#define BENCH_BAT_R_OHM                 0.15    /* Battery internal resistance */
+#define BENCH_BAT_RTH                   20.0    /* C/W, battery to ambient */
+#define BENCH_BAT_COUPLING              0.15    /* Share of the die rise that reaches the battery */
+#define BENCH_BAT_TAU_S                 300.0
+#define BENCH_BAT_HOT_C                 60.0    /* Charging is suspended above this (TS hot) */
+#define BENCH_BAT_HOT_HYST_C            3.0
+
+typedef struct BENCH_DEVICE {
+    double ambient_c;
+    double die_c;
+    double bat_c;
+    double ichg_ma;                 /**< Charge current actually flowing */
+    uint8_t treg;                   /**< Die in thermal regulation */
+    uint8_t hot;                    /**< Charging suspended by TS hot */
+} BENCH_DEVICE;
+
+static uint32_t bench_tick = 1;
+static BQ25895_SIM bench_sim;
+static I2C_HandleTypeDef bench_i2c;
+static BENCH_DEVICE bench_device;
+
+/**
+ * @brief Virtual clock, overrides the monotonic clock of BQ25895_LinuxI2C.c so an hour runs in seconds.
+ */
+uint32_t HAL_GetTick(void) {
+    return bench_tick;
+}
+
+/**
+ * @brief Advance the thermal model by 1ms with the ICHG setting of the simulated charger.
+ * @note The chip itself throttles the current once the die passes TREG and reports THERM_STAT, and
+ * suspends charging while the battery is TS hot.
+ */
+static void Bench_Physics(BENCH_DEVICE *device, const uint8_t *regs) {
+    double ichg = BQ25895_DECODE(regs[BQ25895_REG_04], ICHG);
+    double out_w;
+    double loss_w;
+    double bat_w;
+    double scale;
+
+    if (device->bat_c > BENCH_BAT_HOT_C)
+        device->hot = 1;
+    else if (device->bat_c < BENCH_BAT_HOT_C - BENCH_BAT_HOT_HYST_C)
+        device->hot = 0;
+    device->treg = device->die_c > BENCH_TREG_C;
+    scale = 1.0;
+    if (device->treg)
+        scale = 1.0 - (device->die_c - BENCH_TREG_C) / BENCH_TREG_BAND_C;
+    if (scale < 0)
+        scale = 0;
+    device->ichg_ma = device->hot ? 0 : ichg * scale;
+
+    out_w = BENCH_VBAT_MV / 1000.0 * device->ichg_ma / 1000.0;
+    loss_w = out_w * BENCH_BUCK_LOSS + BENCH_BUCK_R_OHM * (device->ichg_ma / 1000.0) * (device->ichg_ma / 1000.0);
+    bat_w = BENCH_BAT_R_OHM * (device->ichg_ma / 1000.0) * (device->ichg_ma / 1000.0);
+    device->die_c += (device->ambient_c + loss_w * BENCH_DIE_RTH - device->die_c) / (BENCH_DIE_TAU_S * 1000.0);
+    device->bat_c += (device->ambient_c + bat_w * BENCH_BAT_RTH
+            + BENCH_BAT_COUPLING * (device->die_c - device->ambient_c) - device->bat_c) / (BENCH_BAT_TAU_S * 1000.0);
+}
+
+static void Bench_DeviceModel(BQ25895_SIM_CHIP *chip) {
+    const BENCH_DEVICE *device = (const BENCH_DEVICE *) chip->context;
+    uint16_t ts_pct = BQ25895_NTCToPercent(BQ25895_NTC_103AT, (int16_t) (device->bat_c * 10));
+
+    chip->regs[BQ25895_REG_0C] = device->hot ? BQ25895_BUCK_TS_HOT << BQ25895_FAULT_NTC_BIT : 0;
+    chip->regs[BQ25895_REG_0E] = (device->treg ? BQ25895_THERM_STAT_MASK : 0) | BQ25895_ENCODE(BENCH_VBAT_MV, BATV);
+    chip->regs[BQ25895_REG_10] = BQ25895_ENCODE(ts_pct, TSPCT);
+    chip->regs[BQ25895_REG_12] = BQ25895_ENCODE((uint32_t) device->ichg_ma, ICHGR);
+}
+
+/**
+ * @brief Charge for total_ms with or without the governor and report charge and temperatures.
+ */
+static void Bench_Run(const char *name, const BQ25895_TG_CONFIG *config, uint8_t govern, uint32_t total_ms,
+        double ambient_c) {
+    BQ25895_THERMAL_GOVERNOR tg;
+    double charge_mah = 0;
+    double peak_die = ambient_c;
+    double peak_bat = ambient_c;
+    uint32_t treg_ms = 0;
+    uint32_t hot_ms = 0;
+    uint32_t ms;
+    uint8_t ichg = BQ25895_ENCODE(BQ25895_TG_ICHG_MAX_MA, ICHG);
+
+    bench_device = (BENCH_DEVICE) { .ambient_c = ambient_c, .die_c = ambient_c, .bat_c = ambient_c };
+    BQ25895_SimInit(&bench_sim, &bench_i2c, 0);
+    bench_sim.chips[0].model = Bench_DeviceModel;
+    bench_sim.chips[0].context = &bench_device;
+    BQ25895_Init(&bench_i2c);
+    BQ25895_UpdateBits(BQ25895_REG_04, BQ25895_ICHG_MASK, &ichg);
+    if (govern && BQ25895_ThermalGovernorStart(&tg, config) != HAL_OK) {
+        printf("%-26s start failed\n", name);
+        return;
+    }
+
+    for (ms = 0; ms < total_ms; ms++) {
+        bench_tick++;
+        if (govern)
+            BQ25895_ThermalGovernorStep(&tg);
+        Bench_Physics(&bench_device, bench_sim.chips[0].regs);
+        charge_mah += bench_device.ichg_ma / 3600000.0;
+        treg_ms += bench_device.treg;
+        hot_ms += bench_device.hot;
+        if (bench_device.die_c > peak_die)
+            peak_die = bench_device.die_c;
+        if (bench_device.bat_c > peak_bat)
+            peak_bat = bench_device.bat_c;
+    }
+    printf("%-26s %7.0f mAh  die %5.1fC  battery %5.1fC  TREG %5.0f s  TS hot %5.0f s  %5u writes\n", name,
+            charge_mah, peak_die, peak_bat, treg_ms / 1000.0, hot_ms / 1000.0, (unsigned) bench_sim.chips[0].writes);
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = (argc > 1) ? (uint32_t) atoi(argv[1]) : 3600;
+    double ambient_c = (argc > 2) ? atof(argv[2]) : 45.0;
+    BQ25895_TG_CONFIG defaults = {
+        .ichg_max_ma = BQ25895_TG_ICHG_MAX_MA,
+        .ichg_min_ma = BQ25895_TG_ICHG_MIN_MA,
+        .derate_start_pct = BQ25895_TG_DERATE_START_PCT,
+        .derate_end_pct = BQ25895_TG_DERATE_END_PCT,
+        .treg_backoff_q8 = BQ25895_TG_TREG_BACKOFF_Q8,
+        .recover_step_ma = BQ25895_TG_RECOVER_STEP_MA,
+        .slew_down_ma = BQ25895_TG_SLEW_DOWN_MA,
+        .deadband_ma = BQ25895_TG_DEADBAND_MA,
+        .period_ms = BQ25895_TG_PERIOD_MS
+    };
+    BQ25895_TG_CONFIG early = defaults;
+    BQ25895_TG_CONFIG eager = defaults;
+
+    if (seconds == 0)
+        seconds = 3600;
+    /* Derate between 50C and 57C instead of about 58C to 60C, trading charge for a cooler battery */
+    early.derate_start_pct = BQ25895_NTCToPercent(BQ25895_NTC_103AT, 500);
+    early.derate_end_pct = BQ25895_NTCToPercent(BQ25895_NTC_103AT, 570);
+    /* Every ICHG step written */
+    eager.deadband_ma = 0;
+
+    printf("%u s of charging at %.1fC ambient\n", (unsigned) seconds, ambient_c);
+    Bench_Run("fixed ICHG 2048mA", NULL, 0, seconds * 1000, ambient_c);
+    Bench_Run("governor defaults", &defaults, 1, seconds * 1000, ambient_c);
+    Bench_Run("governor, derate 50-57C", &early, 1, seconds * 1000, ambient_c);
+    Bench_Run("governor, no deadband", &eager, 1, seconds * 1000, ambient_c);
+    return 0;
+}
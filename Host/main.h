@@ -0,0 +1,66 @@
+/**
+ *  @brief     Minimal STM32 HAL replacement for building the BQ25895 library on Linux hosts.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*---------------------------------------- HAL DEFINITIONS --------------------------------------*/
+#define HAL_MAX_DELAY                   0xFFFFFFFFU
+#define I2C_MEMADD_SIZE_8BIT            0x00000001U
+
+#ifndef __weak
+#define __weak                          __attribute__((weak))
+#endif
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/*
+ * Register transfer hook for simulated or replayed chargers. A one byte mux write arrives as reg with
+ * len 0.
+ */
+typedef HAL_StatusTypeDef (*BQ25895_HOST_TRANSFER)(void *context, uint16_t addr, uint8_t reg, uint8_t *data,
+        uint16_t len, uint8_t write);
+
+typedef struct I2C_HandleTypeDef {
+    int fd;                             /**< Open /dev/i2c-N, -1 when transfer is used instead */
+    BQ25895_HOST_TRANSFER transfer;     /**< Used when set, fd is ignored */
+    void *context;
+} I2C_HandleTypeDef;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_LinuxI2COpen(I2C_HandleTypeDef *hi2c, const char *path);
+
+void BQ25895_LinuxI2CClose(I2C_HandleTypeDef *hi2c);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout);
+
+uint32_t HAL_GetTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAIN_H */
@@ -13,13 +13,44 @@ extern "C" {
 #endif
 
 #include "main.h"
-#include "BQ25895_reg.h"
+#include "BQ25895_REG.h"
+#include "BQ25895_Bus.h"
 
 /*---------------------------------------- HAL FUNCTION TIMEOUT TIME ----------------------------*/
 #define BQ25895_TIMEOUT			HAL_MAX_DELAY
 
 /*---------------------------------------- DEVICE ADDRESS ---------------------------------------*/
 #define BQ25895_I2C_ADDR		(0x6A << 1)
+#define BQ25895_REG_COUNT		(BQ25895_REG_14 + 1)
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_UPDATE_QUEUE_LEN        4       /* Deferred field updates per state machine */
+
+/* Self clearing command bits of a register, never written back from the register cache */
+#define BQ25895_COMMAND_MASK(reg) \
+    ((reg) == BQ25895_REG_02 ? (BQ25895_CONV_START_MASK | BQ25895_FORCE_DPDM_MASK) : \
+     (reg) == BQ25895_REG_03 ? BQ25895_WDT_RESET_MASK : \
+     (reg) == BQ25895_REG_09 ? (BQ25895_FORCE_ICO_MASK | BQ25895_PUMPX_UP_MASK | BQ25895_PUMPX_DN_MASK) : \
+     (reg) == BQ25895_REG_14 ? BQ25895_RESET_MASK : 0)
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+/* Register cache of one device, kept up to date by every transfer the driver makes to it */
+typedef struct BQ25895_SHADOW {
+    volatile uint8_t regs[BQ25895_REG_COUNT];
+    volatile uint32_t valid;        /**< Bit n set once REG_n was read or written */
+} BQ25895_SHADOW;
+
+/* Field updates a state machine defers to its following steps, one BQ25895_UpdateBits() per step */
+typedef struct BQ25895_UPDATE_QUEUE {
+    uint8_t count;
+    uint8_t index;                  /**< Next update to run */
+    uint8_t reg[BQ25895_UPDATE_QUEUE_LEN];
+    uint8_t mask[BQ25895_UPDATE_QUEUE_LEN];
+    uint8_t value[BQ25895_UPDATE_QUEUE_LEN];
+} BQ25895_UPDATE_QUEUE;
+
+/* Called with the REG_0C contents of every fault register read, see BQ25895_SetFaultHook() */
+typedef void (*BQ25895_FAULT_HOOK)(const BQ25895_BUS_DEVICE *device, uint8_t fault);
 
 
 /*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
@@ -53,8 +84,8 @@ HAL_StatusTypeDef BQ25895_GetADCconversionMode(BQ25895_CONV_RATE *state);
 HAL_StatusTypeDef BQ25895_SetBoostFreq(BQ25895_BOOST_FREQ *state);
 HAL_StatusTypeDef BQ25895_GetBoostFreq(BQ25895_BOOST_FREQ *state);
 
-HAL_StatusTypeDef BQ25895_SetInputCurrntOptimizer(BQ25895_STATE *state);
-HAL_StatusTypeDef BQ25895_GetInputCurrntOptimizer(BQ25895_STATE *state);
+HAL_StatusTypeDef BQ25895_SetInputCurrentOptimizer(BQ25895_STATE *state);
+HAL_StatusTypeDef BQ25895_GetInputCurrentOptimizer(BQ25895_STATE *state);
 
 HAL_StatusTypeDef BQ25895_SetHighVoltageDCP(BQ25895_STATE *state);
 HAL_StatusTypeDef BQ25895_GetHighVoltageDCP(BQ25895_STATE *state);
@@ -202,17 +233,34 @@ HAL_StatusTypeDef BQ25895_GetICOStatus(BQ25895_STATE *state);
 
 HAL_StatusTypeDef BQ25895_GetDevice(DEVICE *device);
 
-HAL_StatusTypeDef BQ25895_GetTSProfile(DEVICE *device);
+HAL_StatusTypeDef BQ25895_GetTSProfile(uint8_t *profile);
 
 HAL_StatusTypeDef BQ25895_GetDevRev(uint8_t *rev);
 
 
 HAL_StatusTypeDef BQ25895_Init(I2C_HandleTypeDef *i2cHandle);
+void BQ25895_SelectDevice(const BQ25895_BUS_DEVICE *device);
+const BQ25895_BUS_DEVICE *BQ25895_GetSelectedDevice(void);
+HAL_StatusTypeDef BQ25895_GetCachedRegister(uint8_t reg, uint8_t *data);
+void BQ25895_FaultCallback(const BQ25895_BUS_DEVICE *device, uint8_t fault);
+void BQ25895_SetFaultHook(BQ25895_FAULT_HOOK hook);
 
 HAL_StatusTypeDef BQ25895_UpdateBits(uint8_t reg, uint8_t mask, uint8_t *data);
+HAL_StatusTypeDef BQ25895_QueueUpdate(BQ25895_UPDATE_QUEUE *queue, uint8_t reg, uint8_t mask, uint8_t value);
+HAL_StatusTypeDef BQ25895_RunQueuedUpdate(BQ25895_UPDATE_QUEUE *queue);
 
 HAL_StatusTypeDef BQ25895_WriteRegister(uint8_t reg, uint8_t *data);
 HAL_StatusTypeDef BQ25895_ReadRegister(uint8_t reg, uint8_t *data);
+HAL_StatusTypeDef BQ25895_ReadRegisters(uint8_t reg, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef BQ25895_WriteRegisters(uint8_t reg, uint8_t *data, uint16_t len);
+
+HAL_StatusTypeDef BQ25895_DeviceRead(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef BQ25895_DeviceWrite(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef BQ25895_DeviceUpdateBits(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t mask,
+        uint8_t *data);
+HAL_StatusTypeDef BQ25895_DeviceSubmit(BQ25895_BUS_REQUEST *req, const BQ25895_BUS_DEVICE *device,
+        BQ25895_BUS_DIR dir, uint8_t reg, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef BQ25895_DevicePoll(BQ25895_BUS_REQUEST *req);
 
 #ifdef __cplusplus
 			}
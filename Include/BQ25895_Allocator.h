@@ -0,0 +1,65 @@
+/**
+ *  @brief     Shared input current budget allocation across several BQ25895 charge controller ICs.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_ALLOCATOR_H
+#define BQ25895_ALLOCATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_ALLOC_MIN_MA            500     /* Floor for a charging bay */
+#define BQ25895_ALLOC_IDLE_MA           200     /* Not charging or terminated: system load only */
+#define BQ25895_ALLOC_HEADROOM_MA       200     /* Margin above the estimated draw of an unconstrained bay */
+#define BQ25895_ALLOC_PROBE_MA          300     /* Extra asked for by a bay held at its limit (IDPM) */
+#define BQ25895_ALLOC_DEADBAND_MA       100     /* Increases smaller than this are not written */
+#define BQ25895_ALLOC_EFFICIENCY_PCT    90
+#define BQ25895_ALLOC_NONE              0xFF
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_ALLOC_CONFIG {
+    uint32_t budget_ma;             /**< Total input current the shared supply can deliver */
+    uint16_t min_ma;
+    uint16_t idle_ma;
+    uint16_t headroom_ma;
+    uint16_t probe_ma;
+    uint16_t deadband_ma;
+    uint8_t efficiency_pct;         /**< Buck efficiency used to estimate input current from charge power */
+} BQ25895_ALLOC_CONFIG;
+
+typedef struct BQ25895_ALLOC_CHARGER {
+    /* Inputs, refreshed by the application every control period */
+    BQ25895_CHRG_STAT chrg_stat;
+    uint16_t ichgr_ma;              /**< ICHGR */
+    uint16_t vbat_mv;               /**< BATV */
+    uint16_t vbus_mv;               /**< VBUSV */
+    uint8_t idpm;                   /**< IDPM_STAT: held at the input current limit */
+    uint8_t vdpm;                   /**< VDPM_STAT: input voltage collapsing */
+    /** IINLIM read back from REG_00, input detection rewrites it behind the allocator's back */
+    uint16_t iinlim_ma;
+    uint16_t max_ma;                /**< Bay ceiling (cable, connector), at most 3250mA, 0 = bay unused */
+    /* Outputs */
+    uint16_t demand_ma;             /**< Estimated input current the bay could use */
+    uint16_t target_ma;             /**< Allocated IINLIM */
+} BQ25895_ALLOC_CHARGER;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_AllocatorRun(const BQ25895_ALLOC_CONFIG *config, BQ25895_ALLOC_CHARGER *chargers, uint8_t count);
+
+uint8_t BQ25895_AllocatorNext(const BQ25895_ALLOC_CHARGER *chargers, uint8_t count);
+
+HAL_StatusTypeDef BQ25895_AllocatorApply(BQ25895_ALLOC_CHARGER *charger);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_ALLOCATOR_H */
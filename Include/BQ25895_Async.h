@@ -0,0 +1,56 @@
+/**
+ *  @brief     Resumable multi-step operations for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_ASYNC_H
+#define BQ25895_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_PT.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_ASYNC_POLL_MS           10      /* Delay between status polls */
+#define BQ25895_ASYNC_RESET_TIMEOUT_MS  100
+#define BQ25895_ASYNC_ICO_TIMEOUT_MS    2000    /* ICO takes up to a few hundred ms per step */
+#define BQ25895_ASYNC_ADC_TIMEOUT_MS    1000    /* One conversion takes about 1s worst case */
+/* REG_0E (BATV) up to and including REG_13 (IDPM_LIM) */
+#define BQ25895_ASYNC_ADC_LEN           (BQ25895_REG_13 - BQ25895_REG_0E + 1)
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_ASYNC {
+    BQ25895_PT pt;
+    const BQ25895_BUS_DEVICE *device;   /**< Charger the operation runs on */
+    uint32_t timeout_ms;
+    uint32_t start_tick;
+    uint32_t tick;                      /**< Last poll */
+    HAL_StatusTypeDef status;           /**< Status of the last transfer */
+    BQ25895_BUS_REQUEST req;            /**< Read waiting for the bus */
+    uint8_t reg;                        /**< Last status register read */
+    uint16_t value;                     /**< Operation result, see the operation */
+    uint8_t data[BQ25895_ASYNC_ADC_LEN]; /**< Raw REG_0E..REG_13 after BQ25895_AsyncADCOneShot() */
+} BQ25895_ASYNC;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_AsyncInit(BQ25895_ASYNC *op, const BQ25895_BUS_DEVICE *device, uint32_t timeout_ms);
+
+HAL_StatusTypeDef BQ25895_AsyncReset(BQ25895_ASYNC *op);
+
+HAL_StatusTypeDef BQ25895_AsyncICO(BQ25895_ASYNC *op);
+
+HAL_StatusTypeDef BQ25895_AsyncADCOneShot(BQ25895_ASYNC *op);
+
+HAL_StatusTypeDef BQ25895_AsyncShipMode(BQ25895_ASYNC *op, BQ25895_STATE delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_ASYNC_H */
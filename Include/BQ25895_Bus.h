@@ -0,0 +1,130 @@
+/**
+ *  @brief     Shared I2C bus scheduler used by the BQ25895 register I/O.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_BUS_H
+#define BQ25895_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Lock.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_BUS_DEFAULT_HZ          100000
+#define BQ25895_BUS_TIMEOUT             HAL_MAX_DELAY
+#define BQ25895_BUS_MAX_BURST           32      /* Largest merged transfer */
+#define BQ25895_BUS_MAX_BATCH           8       /* Most requests served by one transfer */
+#define BQ25895_BUS_MAX_STICKY          4       /* Transfers kept on one mux channel while others wait */
+#define BQ25895_BUS_MUX_NONE            0xFF    /* No mux channel selected or selection unknown */
+
+/*
+ * Critical section around the request queues, taken from BQ25895_Lock.h (no-op unless BQ25895_LOCK_IMPL
+ * selects an implementation). Define both to override.
+ */
+#ifndef BQ25895_BUS_ENTER
+#define BQ25895_BUS_ENTER()             BQ25895_LockEnter()
+#define BQ25895_BUS_EXIT()              BQ25895_LockExit()
+#endif
+/* Called while a synchronous transfer waits for another context to serve it */
+#ifndef BQ25895_BUS_YIELD
+#define BQ25895_BUS_YIELD()             BQ25895_LockYield()
+#endif
+/* 0 if the context owning the bus only resumes once the waiter returns, the wait then ends with HAL_BUSY */
+#ifndef BQ25895_BUS_CAN_WAIT
+#define BQ25895_BUS_CAN_WAIT            BQ25895_LOCK_CAN_WAIT
+#endif
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_BUS_PRIORITY {
+    BQ25895_BUS_FAULT,              /**< Status and fault registers, served first */
+    BQ25895_BUS_CONTROL,            /**< Register writes and configuration reads */
+    BQ25895_BUS_TELEMETRY,          /**< ADC sweeps, served last */
+    BQ25895_BUS_PRIORITY_COUNT
+} BQ25895_BUS_PRIORITY;
+
+typedef enum BQ25895_BUS_DIR {
+    BQ25895_BUS_READ,
+    BQ25895_BUS_WRITE
+} BQ25895_BUS_DIR;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_BUS BQ25895_BUS;
+
+typedef struct BQ25895_BUS_MUX {
+    uint16_t addr;                  /**< 8 bit (shifted) I2C address of the TCA9548 style mux */
+    uint8_t selected;               /**< Channel currently open, #BQ25895_BUS_MUX_NONE if unknown */
+} BQ25895_BUS_MUX;
+
+typedef struct BQ25895_BUS_DEVICE {
+    BQ25895_BUS *bus;
+    uint16_t addr;                  /**< 8 bit (shifted) I2C address */
+    BQ25895_BUS_MUX *mux;           /**< Mux the device sits behind, NULL if directly on the bus */
+    uint8_t channel;                /**< Mux channel 0..7 */
+    struct BQ25895_SHADOW *shadow;  /**< Optional register cache (BQ25895.h), zero initialised, NULL if unused */
+} BQ25895_BUS_DEVICE;
+
+typedef struct BQ25895_BUS_REQUEST {
+    const BQ25895_BUS_DEVICE *device;
+    BQ25895_BUS_DIR dir;
+    BQ25895_BUS_PRIORITY priority;
+    uint8_t reg;
+    uint8_t *data;
+    uint16_t len;
+    HAL_StatusTypeDef status;
+    volatile uint8_t done;          /**< Set once status and data are valid */
+    uint32_t submit_tick;
+    struct BQ25895_BUS_REQUEST *next;
+} BQ25895_BUS_REQUEST;
+
+typedef struct BQ25895_BUS_STATS {
+    uint32_t requests;              /**< Requests served */
+    uint32_t transactions;          /**< I2C transfers issued, lower than requests when batching helps */
+    uint32_t mux_selects;           /**< Channel select writes issued */
+    uint32_t bytes;                 /**< Register bytes moved */
+    uint32_t busy_us;               /**< Estimated time on the wire */
+    uint32_t window_ms;             /**< Time since the statistics were reset */
+    uint16_t utilisation_permille;  /**< busy_us over window_ms */
+    uint32_t max_wait_ms[BQ25895_BUS_PRIORITY_COUNT]; /**< Longest submit to done time per class */
+} BQ25895_BUS_STATS;
+
+struct BQ25895_BUS {
+    I2C_HandleTypeDef *i2c;
+    uint32_t bus_hz;                /**< SCL frequency, only used for the utilisation estimate */
+    BQ25895_BUS_REQUEST *head[BQ25895_BUS_PRIORITY_COUNT];
+    BQ25895_BUS_REQUEST *tail[BQ25895_BUS_PRIORITY_COUNT];
+    uint8_t busy;                   /**< Non-zero while one context is issuing a transfer */
+    BQ25895_BUS_MUX *mux;           /**< Mux with a channel open, NULL if none */
+    uint8_t sticky;                 /**< Transfers in a row served from the open channel ahead of the queue */
+    BQ25895_BUS_STATS stats;
+    uint32_t window_tick;
+};
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_BusInit(BQ25895_BUS *bus, I2C_HandleTypeDef *i2c, uint32_t bus_hz);
+
+void BQ25895_BusMuxInit(BQ25895_BUS_MUX *mux, uint16_t addr);
+
+void BQ25895_BusSubmit(BQ25895_BUS_REQUEST *req);
+
+HAL_StatusTypeDef BQ25895_BusCancel(BQ25895_BUS_REQUEST *req);
+
+HAL_StatusTypeDef BQ25895_BusService(BQ25895_BUS *bus);
+
+HAL_StatusTypeDef BQ25895_BusTransfer(const BQ25895_BUS_DEVICE *device, BQ25895_BUS_PRIORITY priority,
+        BQ25895_BUS_DIR dir, uint8_t reg, uint8_t *data, uint16_t len);
+
+void BQ25895_BusGetStats(BQ25895_BUS *bus, BQ25895_BUS_STATS *stats);
+
+void BQ25895_BusResetStats(BQ25895_BUS *bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_BUS_H */
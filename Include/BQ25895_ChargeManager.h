@@ -0,0 +1,73 @@
+/**
+ *  @brief     Non-blocking charge state machine for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_CHARGEMANAGER_H
+#define BQ25895_CHARGEMANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT TIMINGS --------------------------------------*/
+#define BQ25895_CM_POLL_INTERVAL_MS     100
+#define BQ25895_CM_DETECT_TIMEOUT_MS    1000
+#define BQ25895_CM_ICO_TIMEOUT_MS       2000
+#define BQ25895_CM_FAULT_HOLDOFF_MS     2000
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_CM_STATE {
+    BQ25895_CM_NO_INPUT,
+    BQ25895_CM_INPUT_DETECT,
+    BQ25895_CM_ICO,
+    BQ25895_CM_SUSPENDED,
+    BQ25895_CM_PRE_CHARGE,
+    BQ25895_CM_FAST_CHARGE,
+    BQ25895_CM_TERMINATED,
+    BQ25895_CM_RECHARGE,
+    BQ25895_CM_FAULT
+} BQ25895_CM_STATE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_CM_CONFIG {
+    uint32_t poll_interval_ms;      /**< Minimum time between two status polls */
+    uint32_t detect_timeout_ms;     /**< Maximum time to wait for VBUS_STAT after power good */
+    uint32_t ico_timeout_ms;        /**< Maximum time to wait for ICO_OPTIMIZED */
+    uint32_t fault_holdoff_ms;      /**< Time the faults must stay cleared before charging resumes */
+    BQ25895_STATE run_ico;          /**< Force an ICO run after every input detection */
+} BQ25895_CM_CONFIG;
+
+typedef struct BQ25895_CHARGE_MANAGER {
+    BQ25895_CM_CONFIG config;
+    BQ25895_CM_STATE state;
+    BQ25895_VBUS_STAT vbus_stat;
+    BQ25895_CHRG_STAT chrg_stat;
+    BQ25895_PG_STAT pg_stat;
+    BQ25895_CHRG_FAULT chrg_fault;
+    BQ25895_NTC_FAULT ntc_fault;
+    uint8_t last_fault;             /**< Last non-zero charge related REG_0C value */
+    uint16_t ico_current_ma;        /**< IDPM_LIM reported when ICO finished */
+    BQ25895_UPDATE_QUEUE updates;   /**< Register updates, one run per step */
+    uint32_t state_tick;
+    uint32_t poll_tick;
+    uint32_t clear_tick;
+} BQ25895_CHARGE_MANAGER;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_ChargeManagerInit(BQ25895_CHARGE_MANAGER *cm, const BQ25895_CM_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_ChargeManagerStep(BQ25895_CHARGE_MANAGER *cm);
+
+BQ25895_CM_STATE BQ25895_ChargeManagerGetState(const BQ25895_CHARGE_MANAGER *cm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_CHARGEMANAGER_H */
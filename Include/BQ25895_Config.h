@@ -0,0 +1,63 @@
+/**
+ *  @brief     CRC protected configuration blobs for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_CONFIG_H
+#define BQ25895_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*
+ * Blob layout, bytes only so it can be used in place from memory mapped flash at any alignment:
+ *
+ *   0   magic "BQCF"
+ *   4   version (BQ25895_CONFIG_VERSION)
+ *   5   first register
+ *   6   register count n, first + n <= REG_0A + 1
+ *   7   reserved, 0
+ *   8   mask[n]          bits to write, 0xFF writes the whole register, never a command bit
+ *   8+n value[n]
+ *   8+2n CRC-32 (IEEE 802.3, as zlib.crc32) of bytes 0..8+2n-1, little endian
+ *
+ * Blobs are generated from a readable profile with Tools/config_blob.py.
+ */
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_CONFIG_VERSION          1
+#define BQ25895_CONFIG_HEADER_LEN       8
+#define BQ25895_CONFIG_CRC_LEN          4
+#define BQ25895_CONFIG_LAST_REG         BQ25895_REG_0A
+#define BQ25895_CONFIG_SIZE(count)      (BQ25895_CONFIG_HEADER_LEN + 2 * (count) + BQ25895_CONFIG_CRC_LEN)
+
+/* Bits no blob mask may cover: self clearing commands and BATFET_DIS, as refused by Tools/config_blob.py */
+#define BQ25895_CONFIG_COMMAND_MASK(reg) \
+    (BQ25895_COMMAND_MASK(reg) | ((reg) == BQ25895_REG_09 ? BQ25895_BATFET_DIS_MASK : 0))
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_CONFIG_BLOB {
+    uint8_t magic[4];
+    uint8_t version;
+    uint8_t first;
+    uint8_t count;
+    uint8_t reserved;
+    uint8_t data[];                 /**< mask[count], value[count], CRC-32 */
+} BQ25895_CONFIG_BLOB;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_ConfigCheck(const void *blob, uint32_t size);
+
+HAL_StatusTypeDef BQ25895_ConfigApply(const void *blob, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_CONFIG_H */
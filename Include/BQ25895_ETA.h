@@ -0,0 +1,60 @@
+/**
+ *  @brief     Streaming charge time-to-full estimator for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_ETA_H
+#define BQ25895_ETA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_ETA_CV_MARGIN_MV        (2 * BQ25895_BATV_LSB)
+#define BQ25895_ETA_CV_TAU_S            1800    /* CV current time constant until one is measured */
+#define BQ25895_ETA_MIN_RISE_MV         (3 * BQ25895_BATV_LSB)
+#define BQ25895_ETA_MIN_DECAY_PCT       20
+#define BQ25895_ETA_UNKNOWN             0xFFFFFFFF
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_ETA_PHASE {
+    BQ25895_ETA_CC,
+    BQ25895_ETA_CV,
+    BQ25895_ETA_DONE
+} BQ25895_ETA_PHASE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_ETA {
+    uint16_t ichg_ma;               /**< Configured fast charge current (ICHG) */
+    uint16_t vreg_mv;               /**< Configured charge voltage (VREG) */
+    uint16_t iterm_ma;              /**< Configured termination current (ITERM) */
+    uint16_t cv_tau_s;              /**< CV current decay time constant, measured or default */
+    BQ25895_ETA_PHASE phase;
+    uint8_t valid;                  /**< Non-zero once the first sample anchored the model */
+    uint16_t anchor_mv;             /**< CC phase: BATV at the slope anchor */
+    uint16_t anchor_ma;             /**< CV phase: ICHGR at the decay anchor */
+    uint32_t anchor_ms;
+    uint32_t rise_uv_per_s;         /**< Measured CC phase BATV slope */
+    uint32_t eta_s;                 /**< Cached estimate, #BQ25895_ETA_UNKNOWN until one can be made */
+} BQ25895_ETA;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_ETAInit(BQ25895_ETA *eta);
+
+HAL_StatusTypeDef BQ25895_ETALoad(BQ25895_ETA *eta);
+
+void BQ25895_ETAUpdate(BQ25895_ETA *eta, uint16_t current_ma, uint16_t voltage_mv, uint32_t now_ms);
+
+uint32_t BQ25895_ETAGet(const BQ25895_ETA *eta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_ETA_H */
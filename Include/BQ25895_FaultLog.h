@@ -0,0 +1,85 @@
+/**
+ *  @brief     Per device fault history with batched persistence for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_FAULTLOG_H
+#define BQ25895_FAULTLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_FAULT_LOG_LEN           32      /* Events kept in RAM per device, a power of two */
+#define BQ25895_FAULT_LOG_MAX           8       /* Devices that can be registered */
+#define BQ25895_FAULT_BATCH             8       /* Events handed to the backend per write */
+#define BQ25895_FAULT_FLUSH_MS          60000   /* Longest time an event stays unsaved */
+#define BQ25895_FAULT_RECORD_LEN        16      /* Bytes per event in flash */
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_FAULT_EVENT {
+    uint32_t tick;                  /**< HAL_GetTick() of the read that saw the change */
+    uint8_t device;                 /**< Id given to BQ25895_FaultLogInit() */
+    uint8_t fault;                  /**< REG_0C, 0 when the faults cleared */
+    uint8_t reserved[2];
+} BQ25895_FAULT_EVENT;
+
+typedef struct BQ25895_FAULT_BACKEND {
+    /** Store count events, oldest first. Called from BQ25895_FaultLogService() only. */
+    HAL_StatusTypeDef (*write)(void *context, const BQ25895_FAULT_EVENT *events, uint16_t count);
+    void *context;
+} BQ25895_FAULT_BACKEND;
+
+typedef struct BQ25895_FAULT_LOG {
+    const BQ25895_BUS_DEVICE *device;
+    const BQ25895_FAULT_BACKEND *backend;   /**< NULL keeps the history in RAM only */
+    uint8_t id;
+    uint8_t last_fault;             /**< REG_0C of the previous read */
+    BQ25895_FAULT_EVENT events[BQ25895_FAULT_LOG_LEN];
+    uint32_t total;                 /**< Events appended since init, the next slot is total % LEN */
+    uint32_t saved;                 /**< Events handed to the backend, total - saved are pending */
+    uint32_t lost;                  /**< Events overwritten before they were saved */
+} BQ25895_FAULT_LOG;
+
+/*
+ * Wear levelled flash backend: events are appended as 16 byte records over a ring of pages, a page is
+ * erased just before its first record is written. The flash operations are supplied by the application
+ * because they differ between STM32 families.
+ */
+typedef struct BQ25895_FAULT_FLASH {
+    uintptr_t base;                 /**< Memory mapped address of the first page */
+    uint32_t page_size;             /**< Bytes per page, a multiple of BQ25895_FAULT_RECORD_LEN */
+    uint8_t pages;                  /**< At least 2, so one page of history survives an erase */
+    HAL_StatusTypeDef (*erase)(uintptr_t page);
+    HAL_StatusTypeDef (*program)(uintptr_t addr, const uint8_t *data, uint32_t len);
+    uint32_t offset;                /**< Next record, set by BQ25895_FaultFlashMount() */
+    uint32_t seq;                   /**< Sequence number of the last record */
+} BQ25895_FAULT_FLASH;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_FaultLogInit(BQ25895_FAULT_LOG *log, const BQ25895_BUS_DEVICE *device, uint8_t id,
+        const BQ25895_FAULT_BACKEND *backend);
+
+void BQ25895_FaultLogAppend(BQ25895_FAULT_LOG *log, uint8_t fault, uint32_t tick);
+
+HAL_StatusTypeDef BQ25895_FaultLogGet(const BQ25895_FAULT_LOG *log, uint16_t age, BQ25895_FAULT_EVENT *event);
+
+HAL_StatusTypeDef BQ25895_FaultLogService(BQ25895_FAULT_LOG *log, uint8_t force);
+
+HAL_StatusTypeDef BQ25895_FaultFlashMount(BQ25895_FAULT_FLASH *flash);
+
+HAL_StatusTypeDef BQ25895_FaultFlashWrite(void *context, const BQ25895_FAULT_EVENT *events, uint16_t count);
+
+HAL_StatusTypeDef BQ25895_FaultFlashRead(const BQ25895_FAULT_FLASH *flash, uint32_t age, BQ25895_FAULT_EVENT *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_FAULTLOG_H */
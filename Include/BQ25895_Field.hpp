@@ -0,0 +1,149 @@
+/**
+ *  @brief     Typed register fields for the BQ25895 charge controller IC in C++.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_FIELD_HPP
+#define BQ25895_FIELD_HPP
+
+#include <cstdint>
+
+#include "BQ25895.h"
+
+/*
+ * Header only, C++20. Every field is a type built from the BQ25895_REG.h masks, so a constant setpoint
+ * compiles down to the same single BQ25895_UpdateBits() call with an immediate operand as the C API:
+ *
+ *     using namespace bq25895::literals;
+ *     bq25895::ChargeVoltage::Set<4208_mV>();         // code computed by the compiler
+ *     bq25895::ChargeVoltage::Set<5000_mV>();         // error: out of range
+ *     bq25895::FastChargeCurrent::Set(2048_mA);       // runtime value, clamped to the field range
+ */
+
+namespace bq25895 {
+
+/*------------------------------------ UNIT TYPES -----------------------------------------------*/
+struct MilliVolt {
+    uint16_t value;
+    constexpr bool operator==(const MilliVolt &) const = default;
+};
+
+struct MilliAmp {
+    uint16_t value;
+    constexpr bool operator==(const MilliAmp &) const = default;
+};
+
+struct MilliOhm {
+    uint16_t value;
+    constexpr bool operator==(const MilliOhm &) const = default;
+};
+
+/** TSPCT, in 0.01% of REGN */
+struct CentiPercent {
+    uint16_t value;
+    constexpr bool operator==(const CentiPercent &) const = default;
+};
+
+namespace literals {
+
+consteval MilliVolt operator""_mV(unsigned long long value) {
+    return MilliVolt { static_cast<uint16_t>(value) };
+}
+
+consteval MilliAmp operator""_mA(unsigned long long value) {
+    return MilliAmp { static_cast<uint16_t>(value) };
+}
+
+consteval MilliOhm operator""_mOhm(unsigned long long value) {
+    return MilliOhm { static_cast<uint16_t>(value) };
+}
+
+} // namespace literals
+
+enum class Access {
+    ReadWrite,
+    ReadOnly
+};
+
+/*------------------------------------ FIELD TEMPLATE -------------------------------------------*/
+/**
+ * @brief One value field of a register: value = Base + code * Lsb, code = (reg & Mask) >> Shift.
+ * @tparam Limit Highest valid value when the datasheet caps the field below its code range.
+ */
+template <uint8_t Reg, uint8_t Mask, uint8_t Shift, uint16_t Base, uint16_t Lsb, typename Unit,
+        Access Mode = Access::ReadWrite, uint16_t Limit = Base + (Mask >> Shift) * Lsb>
+struct Field {
+    static constexpr uint8_t reg = Reg;
+    static constexpr uint8_t mask = Mask;
+    static constexpr Unit min { Base };
+    static constexpr Unit max { Limit };
+
+    static_assert(Mask != 0 && ((Mask >> Shift) << Shift) == Mask, "mask does not match shift");
+    static_assert(Lsb != 0, "field without a step");
+    static_assert(Limit >= Base && Limit <= Base + (Mask >> Shift) * Lsb, "limit outside the code range");
+
+    /** Register bits of a value, rounded down to the step like the C API, clamped to the field range */
+    static constexpr uint8_t Encode(Unit value) {
+        uint16_t v = value.value < Base ? Base : (value.value > Limit ? Limit : value.value);
+        return static_cast<uint8_t>((((v - Base) / Lsb) << Shift) & Mask);
+    }
+
+    static constexpr Unit Decode(uint8_t reg_val) {
+        return Unit { static_cast<uint16_t>(((reg_val & Mask) >> Shift) * Lsb + Base) };
+    }
+
+    /** Write a constant, rejected at compile time when out of range */
+    template <Unit Value>
+    static HAL_StatusTypeDef Set() {
+        static_assert(Mode == Access::ReadWrite, "read only field");
+        static_assert(Value.value >= Base && Value.value <= Limit, "value out of range");
+        constexpr uint8_t code = Encode(Value);
+        uint8_t temp = code;
+        return BQ25895_UpdateBits(Reg, Mask, &temp);
+    }
+
+    static HAL_StatusTypeDef Set(Unit value) {
+        static_assert(Mode == Access::ReadWrite, "read only field");
+        uint8_t temp = Encode(value);
+        return BQ25895_UpdateBits(Reg, Mask, &temp);
+    }
+
+    static HAL_StatusTypeDef Get(Unit &value) {
+        uint8_t temp;
+        HAL_StatusTypeDef status = BQ25895_ReadRegister(Reg, &temp);
+        if (status == HAL_OK)
+            value = Decode(temp);
+        return status;
+    }
+};
+
+#define BQ25895_FIELD_TYPE(reg, field, unit, ...)                                                   \
+    Field<BQ25895_##reg, BQ25895_##field##_MASK, BQ25895_##field##_BIT, BQ25895_##field##_BASE,     \
+            BQ25895_##field##_LSB, unit __VA_OPT__(,) __VA_ARGS__>
+
+/*------------------------------------ FIELDS ---------------------------------------------------*/
+using InputCurrentLimit = BQ25895_FIELD_TYPE(REG_00, IINLIM, MilliAmp);
+using InputVoltageLimitOffset = BQ25895_FIELD_TYPE(REG_01, VINDPMOS, MilliVolt);
+using SysMinVoltage = BQ25895_FIELD_TYPE(REG_03, SYS_MINV, MilliVolt);
+using FastChargeCurrent = BQ25895_FIELD_TYPE(REG_04, ICHG, MilliAmp, Access::ReadWrite, 5056);
+using PrechargeCurrent = BQ25895_FIELD_TYPE(REG_05, IPRECHG, MilliAmp);
+using TerminationCurrent = BQ25895_FIELD_TYPE(REG_05, ITERM, MilliAmp);
+using ChargeVoltage = BQ25895_FIELD_TYPE(REG_06, VREG, MilliVolt, Access::ReadWrite, 4608);
+using IRCompResistance = BQ25895_FIELD_TYPE(REG_08, BAT_COMP, MilliOhm);
+using IRCompVoltage = BQ25895_FIELD_TYPE(REG_08, VCLAMP, MilliVolt);
+using BoostVoltage = BQ25895_FIELD_TYPE(REG_0A, BOOSTV, MilliVolt);
+using InputVoltageLimit = BQ25895_FIELD_TYPE(REG_0D, VINDPM, MilliVolt);
+using BatteryVoltage = BQ25895_FIELD_TYPE(REG_0E, BATV, MilliVolt, Access::ReadOnly);
+using SystemVoltage = BQ25895_FIELD_TYPE(REG_0F, SYSV, MilliVolt, Access::ReadOnly);
+using TSVoltage = BQ25895_FIELD_TYPE(REG_10, TSPCT, CentiPercent, Access::ReadOnly);
+using VBUSVoltage = BQ25895_FIELD_TYPE(REG_11, VBUSV, MilliVolt, Access::ReadOnly);
+using ChargeCurrent = BQ25895_FIELD_TYPE(REG_12, ICHGR, MilliAmp, Access::ReadOnly);
+using ICOInputCurrentLimit = BQ25895_FIELD_TYPE(REG_13, IDPM_LIM, MilliAmp, Access::ReadOnly);
+
+#undef BQ25895_FIELD_TYPE
+
+} // namespace bq25895
+
+#endif /* BQ25895_FIELD_HPP */
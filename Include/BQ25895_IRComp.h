@@ -0,0 +1,66 @@
+/**
+ *  @brief     Battery resistance estimation and IR compensation tuning for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_IRCOMP_H
+#define BQ25895_IRCOMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_IRCOMP_MIN_STEP_MA      500
+#define BQ25895_IRCOMP_MAX_PAIR_MS      2000
+#define BQ25895_IRCOMP_WEIGHT_Q8        64      /* 0.25 per new resistance sample */
+#define BQ25895_IRCOMP_FRACTION_Q8      128     /* Compensate 50% of the measured resistance */
+#define BQ25895_IRCOMP_MAX_COMP_MOHM    80
+#define BQ25895_IRCOMP_MAX_CLAMP_MV     96
+#define BQ25895_IRCOMP_MIN_SAMPLES      4
+#define BQ25895_IRCOMP_MAX_MOHM         1000    /* Larger steps are treated as load changes, not resistance */
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_IRCOMP_CONFIG {
+    uint16_t min_step_ma;           /**< Current change needed between two samples to measure resistance */
+    uint32_t max_pair_ms;           /**< Samples further apart than this are not paired */
+    uint16_t weight_q8;             /**< Weight of a new resistance sample in the running average, Q8 */
+    uint16_t comp_fraction_q8;      /**< Fraction of the estimated resistance programmed to BAT_COMP, Q8 */
+    uint8_t max_comp_mohm;          /**< Upper limit for BAT_COMP, at most 140mOhm */
+    uint8_t max_clamp_mv;           /**< Upper limit for VCLAMP, at most 224mV */
+    uint8_t min_samples;            /**< Resistance samples needed before BQ25895_IRCompTune() writes anything */
+} BQ25895_IRCOMP_CONFIG;
+
+typedef struct BQ25895_IRCOMP {
+    BQ25895_IRCOMP_CONFIG config;
+    uint8_t has_last;
+    uint8_t samples;
+    uint16_t last_ma;
+    uint16_t last_mv;
+    uint32_t last_ms;
+    uint16_t peak_ma;               /**< Highest charge current seen, sizes VCLAMP */
+    uint32_t r_mohm_q8;             /**< Running average of the measured resistance, Q8 */
+    uint8_t written;                /**< Non-zero once BAT_COMP and VCLAMP were written */
+    uint8_t comp_mohm;              /**< Last written BAT_COMP */
+    uint8_t clamp_mv;               /**< Last written VCLAMP */
+} BQ25895_IRCOMP;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_IRCompInit(BQ25895_IRCOMP *ir, const BQ25895_IRCOMP_CONFIG *config);
+
+void BQ25895_IRCompAddSample(BQ25895_IRCOMP *ir, uint16_t current_ma, uint16_t voltage_mv, uint32_t now_ms);
+
+uint16_t BQ25895_IRCompGetResistance(const BQ25895_IRCOMP *ir);
+
+HAL_StatusTypeDef BQ25895_IRCompTune(BQ25895_IRCOMP *ir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_IRCOMP_H */
@@ -0,0 +1,66 @@
+/**
+ *  @brief     Closed-loop input power optimizer for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_INPUTOPTIMIZER_H
+#define BQ25895_INPUTOPTIMIZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_IO_IINLIM_MIN_MA        500
+#define BQ25895_IO_IINLIM_MAX_MA        3250
+#define BQ25895_IO_IINLIM_STEP_MA       BQ25895_IINLIM_LSB
+#define BQ25895_IO_VINDPM_MIN_MV        4300
+#define BQ25895_IO_VINDPM_MAX_MV        4600
+#define BQ25895_IO_VINDPM_HEADROOM_MV   600
+#define BQ25895_IO_PERIOD_MS            200
+#define BQ25895_IO_PROBE_INTERVAL_MS    30000
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_IO_CONFIG {
+    uint16_t iinlim_min_ma;         /**< Lowest input current limit the optimizer will set */
+    uint16_t iinlim_max_ma;         /**< Highest input current limit the optimizer will set */
+    uint16_t iinlim_step_ma;        /**< IINLIM change per control period, multiple of 50mA */
+    uint16_t vindpm_min_mv;         /**< Lowest absolute VINDPM threshold */
+    uint16_t vindpm_max_mv;         /**< Highest absolute VINDPM threshold */
+    uint16_t vindpm_headroom_mv;    /**< VINDPM is kept this far below the lightly loaded VBUS */
+    uint32_t period_ms;             /**< Control period */
+    uint32_t probe_interval_ms;     /**< Time after which a learned current ceiling is dropped and re-probed */
+} BQ25895_IO_CONFIG;
+
+typedef struct BQ25895_INPUT_OPTIMIZER {
+    BQ25895_IO_CONFIG config;
+    uint8_t pending;                /**< IINLIM and VINDPM changes waiting to be written */
+    uint8_t probing;                /**< Non-zero while the last IINLIM increase is being evaluated */
+    uint16_t iinlim_ma;
+    uint16_t ceiling_ma;
+    uint16_t vindpm_mv;
+    uint16_t vbus_mv;
+    uint16_t vbus_open_mv;          /**< VBUS measured while neither VINDPM nor IINDPM was active */
+    uint16_t ichg_ma;
+    uint16_t probe_ichg_ma;         /**< Charge current before the last IINLIM increase */
+    BQ25895_STATE vdpm_stat;
+    BQ25895_STATE idpm_stat;
+    uint32_t tick;
+    uint32_t probe_tick;
+} BQ25895_INPUT_OPTIMIZER;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_InputOptimizerStart(BQ25895_INPUT_OPTIMIZER *opt, const BQ25895_IO_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_InputOptimizerStep(BQ25895_INPUT_OPTIMIZER *opt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_INPUTOPTIMIZER_H */
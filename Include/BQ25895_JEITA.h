@@ -0,0 +1,62 @@
+/**
+ *  @brief     Software JEITA charge profile engine for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_JEITA_H
+#define BQ25895_JEITA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_NTC.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_JEITA_HYSTERESIS_DC     20      /* 2.0C */
+#define BQ25895_JEITA_MIN_DWELL_MS      10000
+#define BQ25895_JEITA_PERIOD_MS         1000
+#define BQ25895_JEITA_NO_BAND           0xFF
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_JEITA_BAND {
+    int16_t temp_low_dc;            /**< Band lower edge in 0.1C (inclusive) */
+    int16_t temp_high_dc;           /**< Band upper edge in 0.1C (exclusive) */
+    uint16_t ichg_ma;               /**< Fast charge current in this band, 0 disables charge */
+    uint16_t vreg_mv;               /**< Charge voltage in this band */
+} BQ25895_JEITA_BAND;
+
+typedef struct BQ25895_JEITA_CONFIG {
+    const BQ25895_JEITA_BAND *bands;    /**< Bands sorted by temperature, outside all bands charging stops */
+    uint8_t band_count;
+    BQ25895_NTC_PROFILE profile;
+    int16_t hysteresis_dc;          /**< A band is only left once the temperature is this far past its edge */
+    uint32_t min_dwell_ms;          /**< Minimum time between two band changes */
+    uint32_t period_ms;             /**< Temperature sampling period */
+} BQ25895_JEITA_CONFIG;
+
+typedef struct BQ25895_JEITA {
+    BQ25895_JEITA_CONFIG config;
+    uint8_t band;                   /**< Applied band index or #BQ25895_JEITA_NO_BAND */
+    uint8_t applied;                /**< Non-zero once a setpoint was written */
+    int16_t temp_dc;
+    uint16_t ichg_ma;               /**< Applied charge current */
+    uint16_t vreg_mv;               /**< Applied charge voltage */
+    uint32_t tick;
+    uint32_t change_tick;
+} BQ25895_JEITA;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_JEITAInit(BQ25895_JEITA *jeita, const BQ25895_JEITA_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_JEITAUpdate(BQ25895_JEITA *jeita);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_JEITA_H */
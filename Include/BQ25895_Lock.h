@@ -0,0 +1,78 @@
+/**
+ *  @brief     Pluggable locking for the BQ25895 register I/O.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_LOCK_H
+#define BQ25895_LOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/*---------------------------------------- LOCK IMPLEMENTATIONS ---------------------------------*/
+#define BQ25895_LOCK_NONE               0       /* Single context, every lock is a no-op */
+#define BQ25895_LOCK_CRITICAL           1       /* Bare metal, PRIMASK for short sections, flags for locks */
+#define BQ25895_LOCK_FREERTOS           2       /* FreeRTOS mutexes and critical sections */
+#define BQ25895_LOCK_PTHREAD            3       /* POSIX threads, for host builds */
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+/* Select the implementation with -DBQ25895_LOCK_IMPL=BQ25895_LOCK_FREERTOS (or similar) */
+#ifndef BQ25895_LOCK_IMPL
+#define BQ25895_LOCK_IMPL               BQ25895_LOCK_NONE
+#endif
+/* Waiting lets the holder run. Not so on bare metal, where the holder is the context an interrupt preempted */
+#define BQ25895_LOCK_CAN_WAIT           (BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS \
+                                        || BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD)
+/* FreeRTOS thread local storage slot holding the context pointer, needs configNUM_THREAD_LOCAL_STORAGE_POINTERS */
+#ifndef BQ25895_LOCK_TLS_INDEX
+#define BQ25895_LOCK_TLS_INDEX          0
+#endif
+
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+#include "FreeRTOS.h"
+#include "semphr.h"
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+#include <pthread.h>
+#endif
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_LOCK {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    SemaphoreHandle_t handle;
+    StaticSemaphore_t buffer;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    pthread_mutex_t mutex;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+    volatile uint8_t taken;
+#else
+    uint8_t unused;
+#endif
+} BQ25895_LOCK;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_LockInit(BQ25895_LOCK *lock);
+
+HAL_StatusTypeDef BQ25895_LockTake(BQ25895_LOCK *lock);
+
+void BQ25895_LockGive(BQ25895_LOCK *lock);
+
+void BQ25895_LockEnter(void);
+
+void BQ25895_LockExit(void);
+
+void BQ25895_LockYield(void);
+
+void *BQ25895_LockGetLocal(void);
+
+void BQ25895_LockSetLocal(void *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_LOCK_H */
@@ -0,0 +1,76 @@
+/**
+ *  @brief     Solar maximum power point tracking on top of the BQ25895 absolute VINDPM control.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_MPPT_H
+#define BQ25895_MPPT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_MPPT_STEP_MV            BQ25895_VINDPM_LSB
+#define BQ25895_MPPT_PERIOD_MS          500
+#define BQ25895_MPPT_VINDPM_MIN_MV      3900
+#define BQ25895_MPPT_VINDPM_MAX_MV      15300
+#define BQ25895_MPPT_VOC_RATIO_Q8       200     /* 0.78 x Voc */
+#define BQ25895_MPPT_VOC_INTERVAL_MS    60000
+#define BQ25895_MPPT_VOC_SETTLE_MS      50
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_MPPT_MODE {
+    BQ25895_MPPT_PERTURB_OBSERVE,
+    BQ25895_MPPT_FRACTIONAL_VOC
+} BQ25895_MPPT_MODE;
+
+typedef enum BQ25895_MPPT_PHASE {
+    BQ25895_MPPT_TRACK,
+    BQ25895_MPPT_VOC_OPEN,
+    BQ25895_MPPT_VOC_SETTLE,
+    BQ25895_MPPT_VOC_CLOSE
+} BQ25895_MPPT_PHASE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_MPPT_CONFIG {
+    BQ25895_MPPT_MODE mode;
+    uint16_t step_mv;               /**< VINDPM perturbation per iteration, multiple of 100mV */
+    uint32_t period_ms;             /**< Iteration period, together with step_mv sets the tracking speed */
+    uint16_t vindpm_min_mv;
+    uint16_t vindpm_max_mv;
+    uint16_t voc_ratio_q8;          /**< Fraction of Voc used as operating point, Q8 (256 = 1.0) */
+    uint32_t voc_interval_ms;       /**< Open-circuit voltage re-measure interval, 0 = only at start */
+    uint32_t voc_settle_ms;         /**< Time VBUS is given to rise after the input is opened */
+} BQ25895_MPPT_CONFIG;
+
+typedef struct BQ25895_MPPT {
+    BQ25895_MPPT_CONFIG config;
+    BQ25895_MPPT_PHASE phase;
+    uint8_t pending;                /**< Non-zero when vindpm_mv has to be written */
+    int8_t direction;               /**< Perturbation direction, +1 or -1 */
+    uint16_t vindpm_mv;
+    uint16_t voc_mv;
+    uint16_t vbus_mv;
+    uint16_t vbat_mv;
+    uint16_t ichg_ma;
+    uint32_t power_mw;              /**< Charge power (VBAT x ICHG) of the last iteration */
+    uint32_t tick;
+    uint32_t voc_tick;
+} BQ25895_MPPT;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_MPPTStart(BQ25895_MPPT *mppt, const BQ25895_MPPT_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_MPPTStep(BQ25895_MPPT *mppt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_MPPT_H */
@@ -0,0 +1,50 @@
+/**
+ *  @brief     NTC percentage to temperature conversion for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_NTC_H
+#define BQ25895_NTC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_NTC_PROFILE {
+    BQ25895_NTC_103AT,              /**< 10k B3435 NTC, RT1 = 5.23k, RT2 = 30.1k */
+    BQ25895_NTC_NCP15XH103,         /**< 10k B3380 NTC, RT1 = 5.23k, RT2 = 30.1k */
+    BQ25895_NTC_100K_B4250,         /**< 100k B4250 NTC, RT1 = 52.3k, RT2 = 301k */
+    BQ25895_NTC_PROFILE_COUNT
+} BQ25895_NTC_PROFILE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_NTC_TABLE {
+    int16_t t0_dc;                  /**< Temperature of the first entry in 0.1C */
+    int16_t step_dc;                /**< Temperature step between entries in 0.1C */
+    uint8_t count;
+    const uint16_t *ts_pct;         /**< TS voltage as percentage of REGN x100, descending */
+} BQ25895_NTC_TABLE;
+
+/* Generated by Tools/ntc_table.py into BQ25895_NTCTable.c */
+extern const BQ25895_NTC_TABLE BQ25895_NTC_TABLES[BQ25895_NTC_PROFILE_COUNT];
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+int16_t BQ25895_NTCToTemperature(BQ25895_NTC_PROFILE profile, uint16_t percent);
+uint16_t BQ25895_NTCToPercent(BQ25895_NTC_PROFILE profile, int16_t temp_dc);
+
+BQ25895_BHOT BQ25895_NTCToBoostHotTH(BQ25895_NTC_PROFILE profile, int16_t temp_dc);
+BQ25895_BCOLD BQ25895_NTCToBoostColdTH(BQ25895_NTC_PROFILE profile, int16_t temp_dc);
+
+HAL_StatusTypeDef BQ25895_GetTemperature(BQ25895_NTC_PROFILE profile, int16_t *temp_dc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_NTC_H */
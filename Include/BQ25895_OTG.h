@@ -0,0 +1,85 @@
+/**
+ *  @brief     OTG boost mode power manager for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_OTG_H
+#define BQ25895_OTG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_NTC.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_OTG_PERIOD_MS           200
+#define BQ25895_OTG_HOT_DC              550     /* 55.0C */
+#define BQ25895_OTG_COLD_DC             (-100)  /* -10.0C */
+#define BQ25895_OTG_HYST_DC             30
+#define BQ25895_OTG_HEAVY_DROOP_MV      200     /* VBUS this far below BOOSTV counts as heavy load */
+#define BQ25895_OTG_HEAVY_SYS_DROOP_MV  150     /* SYSV this far below the no load BATV counts as heavy load */
+#define BQ25895_OTG_IDLE_DROOP_MV       BQ25895_VBUSV_LSB /* VBUS at or above BOOSTV minus this counts as no load */
+#define BQ25895_OTG_IDLE_MS             2000
+#define BQ25895_OTG_FAULT_BACKOFF_MS    500
+#define BQ25895_OTG_FAULT_MAX_BACKOFF_MS 30000
+#define BQ25895_OTG_FAULT_CLEAR_MS      60000
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_OTG_CONFIG {
+    BQ25895_NTC_PROFILE profile;
+    int16_t hot_dc;                 /**< Boost is stopped above this battery temperature, 0.1C */
+    int16_t cold_dc;                /**< Boost is stopped below this battery temperature, 0.1C */
+    int16_t hyst_dc;                /**< Boost restarts this far inside the window */
+    uint16_t heavy_droop_mv;
+    uint16_t heavy_sys_droop_mv;    /**< Battery and BATFET drop under the boost input current, 0 to ignore */
+    uint16_t idle_droop_mv;         /**< At least one VBUSV step (100mV), VBUSV reads below BOOSTV even at no load */
+    BQ25895_BOOST_FREQ light_freq;  /**< Frequency for light loads, 500kHz has the lower switching loss */
+    BQ25895_BOOST_FREQ heavy_freq;  /**< Frequency for heavy loads, 1.5MHz has the lower inductor ripple.
+                                         Applied at the first no load reading after a heavy load, or when
+                                         boost restarts after a BOOST_FAULT */
+    uint32_t idle_ms;               /**< No load time needed before moving back to light_freq */
+    uint32_t period_ms;
+    uint32_t fault_backoff_ms;      /**< First restart delay after BOOST_FAULT, doubled per fault */
+    uint32_t fault_max_backoff_ms;
+    uint32_t fault_clear_ms;        /**< Fault free run time after which the fault count is reset */
+} BQ25895_OTG_CONFIG;
+
+typedef struct BQ25895_OTG_MANAGER {
+    BQ25895_OTG_CONFIG config;
+    BQ25895_STATE requested;        /**< OTG wanted by the application */
+    uint8_t running;                /**< Non-zero while OTG_CONFIG is set by the manager */
+    uint8_t heavy;                  /**< Non-zero when a heavy load was seen since the last no load reading */
+    uint8_t temp_block;             /**< Non-zero while the battery is outside the temperature window */
+    uint8_t faults;                 /**< BOOST_FAULT count since the last fault free period */
+    BQ25895_BOOST_FREQ freq;        /**< BOOST_FREQ as last written */
+    uint16_t boostv_mv;
+    uint16_t vbus_mv;
+    uint16_t vbat_mv;
+    uint16_t sysv_mv;
+    uint16_t vbat_rest_mv;          /**< BATV at the last no load reading, 0 until boost ran without load */
+    int16_t temp_dc;
+    BQ25895_UPDATE_QUEUE updates;   /**< Register updates, one run per step */
+    uint32_t tick;
+    uint32_t idle_tick;             /**< Start of the present no load period */
+    uint32_t start_tick;            /**< Last boost start */
+    uint32_t fault_tick;            /**< Last BOOST_FAULT */
+    uint32_t backoff_ms;
+} BQ25895_OTG_MANAGER;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_OTGStart(BQ25895_OTG_MANAGER *otg, const BQ25895_OTG_CONFIG *config);
+
+void BQ25895_OTGRequest(BQ25895_OTG_MANAGER *otg, BQ25895_STATE state);
+
+HAL_StatusTypeDef BQ25895_OTGStep(BQ25895_OTG_MANAGER *otg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_OTG_H */
@@ -0,0 +1,45 @@
+/**
+ *  @brief     Oversampling and decimation of the BQ25895 ADC readings.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_OVERSAMPLE_H
+#define BQ25895_OVERSAMPLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_REG.h"
+
+/*---------------------------------------- LIMITS -----------------------------------------------*/
+#define BQ25895_OVERSAMPLE_MAX_BITS     4       /* 256 samples per output keeps the running sums in 32 bits */
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_OVERSAMPLE {
+    uint32_t base_uv;
+    uint32_t lsb_uv;
+    uint8_t extra_bits;             /**< Resolution gained, 4^extra_bits samples per output */
+    uint8_t ready;                  /**< Non-zero once the first output is available */
+    uint16_t count;
+    uint32_t sum;                   /**< Running sum of ADC codes in the current block */
+    uint32_t sum_sq;                /**< Running sum of squared ADC codes in the current block */
+    uint32_t estimate_uv;
+    uint32_t confidence_uv;         /**< One standard error of estimate_uv */
+} BQ25895_OVERSAMPLE;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_OversampleInit(BQ25895_OVERSAMPLE *os, uint16_t base_mv, uint16_t lsb_mv, uint8_t extra_bits);
+
+uint8_t BQ25895_OversampleAdd(BQ25895_OVERSAMPLE *os, uint8_t code);
+
+uint32_t BQ25895_OversampleGet(const BQ25895_OVERSAMPLE *os, uint32_t *confidence_uv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_OVERSAMPLE_H */
@@ -0,0 +1,72 @@
+/**
+ *  @brief     Stackless protothreads for resumable BQ25895 operations.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_PT_H
+#define BQ25895_PT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/*
+ * A protothread is a function returning HAL_BUSY while it waits and its final status once done. It
+ * resumes at the line it last yielded from, through a switch on the saved line number. Local variables
+ * do not survive a yield, keep state in the operation struct. Do not use switch statements inside a
+ * protothread body and use at most one BQ25895_PT_* wait per source line.
+ */
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_PT_DONE                 0xFFFF
+
+/* Marks the deliberate fall through into a resume label for -Wimplicit-fallthrough */
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define BQ25895_PT_FALLTHROUGH          __attribute__((fallthrough))
+#endif
+#endif
+#ifndef BQ25895_PT_FALLTHROUGH
+#define BQ25895_PT_FALLTHROUGH          do { } while (0)
+#endif
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_PT {
+    uint16_t lc;                    /**< Line to resume at, 0 before the first call */
+} BQ25895_PT;
+
+/*---------------------------------------- MACROS -----------------------------------------------*/
+#define BQ25895_PT_INIT(pt)             ((pt)->lc = 0)
+
+#define BQ25895_PT_IS_DONE(pt)          ((pt)->lc == BQ25895_PT_DONE)
+
+#define BQ25895_PT_BEGIN(pt)            switch ((pt)->lc) { case 0:
+
+/* Return HAL_BUSY once, continue here on the next call */
+#define BQ25895_PT_YIELD(pt)                                                                        \
+    do { (pt)->lc = __LINE__; return HAL_BUSY; case __LINE__:; } while (0)
+
+/* Return HAL_BUSY until cond is true, cond is evaluated again on every call */
+#define BQ25895_PT_WAIT_UNTIL(pt, cond)                                                             \
+    do { (pt)->lc = __LINE__; BQ25895_PT_FALLTHROUGH; case __LINE__: if (!(cond)) return HAL_BUSY; } while (0)
+
+/* Return HAL_BUSY at least once, then until cond is true, cond is evaluated once per later call */
+#define BQ25895_PT_YIELD_UNTIL(pt, cond)                                                            \
+    do { (pt)->lc = __LINE__; return HAL_BUSY; case __LINE__: if (!(cond)) return HAL_BUSY; } while (0)
+
+/* Finish with status, later calls keep returning status */
+#define BQ25895_PT_EXIT(pt, status)                                                                 \
+    do { (pt)->lc = BQ25895_PT_DONE; return (status); } while (0)
+
+#define BQ25895_PT_END(pt, status)                                                                  \
+    default: break; } (pt)->lc = BQ25895_PT_DONE; return (status)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_PT_H */
@@ -0,0 +1,78 @@
+/**
+ *  @brief     Fast plug-in handling from input detection to optimal input current for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_PLUGIN_H
+#define BQ25895_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT TIMINGS --------------------------------------*/
+#define BQ25895_PLUGIN_POLL_INTERVAL_MS     20
+#define BQ25895_PLUGIN_DETECT_TIMEOUT_MS    1000
+#define BQ25895_PLUGIN_ICO_MIN_POLL_MS      10
+#define BQ25895_PLUGIN_ICO_MAX_POLL_MS      160
+#define BQ25895_PLUGIN_ICO_TIMEOUT_MS       2000
+#define BQ25895_PLUGIN_RETRIGGER_MS         2000
+#define BQ25895_PLUGIN_ICO_HOLDOFF_MS       30000
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_PLUGIN_PHASE {
+    BQ25895_PLUGIN_WAIT_PG,         /**< No input, waiting for power good */
+    BQ25895_PLUGIN_DETECT,          /**< Power good, waiting for the input source type */
+    BQ25895_PLUGIN_LIMIT,           /**< Writing the starting IINLIM for the detected source */
+    BQ25895_PLUGIN_ICO_START,       /**< Writing FORCE_ICO */
+    BQ25895_PLUGIN_ICO_POLL,        /**< Polling ICO_OPTIMIZED with increasing intervals */
+    BQ25895_PLUGIN_READY            /**< Input current settled, watching for unplug and source changes */
+} BQ25895_PLUGIN_PHASE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_PLUGIN_CONFIG {
+    uint32_t poll_interval_ms;      /**< Status poll interval while waiting for or watching the input */
+    uint32_t detect_timeout_ms;     /**< Maximum time to wait for VBUS_STAT after power good */
+    uint32_t ico_min_poll_ms;       /**< First ICO_OPTIMIZED poll interval, doubled on every poll */
+    uint32_t ico_max_poll_ms;
+    uint32_t ico_timeout_ms;
+    uint32_t retrigger_ms;          /**< Time VDPM/IDPM must persist before ICO is run again */
+    uint32_t ico_holdoff_ms;        /**< Minimum time between two ICO runs on the same input */
+    BQ25895_STATE run_ico;          /**< Force an ICO run after the starting IINLIM is written */
+} BQ25895_PLUGIN_CONFIG;
+
+typedef struct BQ25895_PLUGIN {
+    BQ25895_PLUGIN_CONFIG config;
+    BQ25895_PLUGIN_PHASE phase;
+    BQ25895_VBUS_STAT vbus_stat;
+    uint16_t iinlim_ma;             /**< Starting IINLIM written for the detected source */
+    uint16_t ico_current_ma;        /**< IDPM_LIM reported when ICO finished, 0 if it timed out */
+    uint16_t ico_cache_ma[BQ25895_OTG + 1]; /**< Last ICO result per VBUS_STAT, 0 if none */
+    uint8_t ico_pending;            /**< Non-zero when ICO has to run after the IINLIM write */
+    uint8_t ico_done;               /**< Non-zero once ICO finished on the present input */
+    uint32_t detect_ms;             /**< Power good to VBUS_STAT latency of the last plug-in */
+    uint32_t latency_ms;            /**< Power good to settled input current latency of the last plug-in */
+    uint32_t poll_ms;
+    uint32_t plug_tick;
+    uint32_t ico_tick;              /**< Start of the last ICO run */
+    uint32_t dpm_tick;              /**< Start of the present VDPM/IDPM episode */
+    uint32_t tick;
+} BQ25895_PLUGIN;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+uint16_t BQ25895_PlugInDefaultLimit(BQ25895_VBUS_STAT vbus_stat);
+
+HAL_StatusTypeDef BQ25895_PlugInStart(BQ25895_PLUGIN *pi, const BQ25895_PLUGIN_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_PlugInStep(BQ25895_PLUGIN *pi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_PLUGIN_H */
@@ -0,0 +1,117 @@
+/**
+ *  @brief     Compile time battery chemistry profiles for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_PROFILE_H
+#define BQ25895_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_PROFILE_LEN             (BQ25895_REG_07 - BQ25895_REG_04 + 1)
+#define BQ25895_PROFILE_REF_MAH         2000    /* Cell capacity of the built in profiles */
+#define BQ25895_PROFILE_VREG_MAX_MV     4608    /* Datasheet limit below the VREG code range */
+#define BQ25895_PROFILE_ICHG_MAX_MA     5056    /* Datasheet limit below the ICHG code range */
+#define BQ25895_PROFILE_ICHG_MIN_MA     BQ25895_ICHG_LSB        /* ICHG 0 disables charging */
+
+#ifndef BQ25895_PROFILE_WATCHDOG
+#define BQ25895_PROFILE_WATCHDOG        BQ25895_WATCHDOG_40S
+#endif
+#ifndef BQ25895_PROFILE_CHG_TIMER
+#define BQ25895_PROFILE_CHG_TIMER       BQ25895_CHG_TIMER_12HOURS
+#endif
+
+/*
+ * Chemistries: VREG (mV), BATLOWV, VRECHG, fast charge rate and precharge/termination rate in % of C.
+ * LiFePO4 (3.6V) and LTO cells are not listed: their charge voltage is below the 3840mV VREG minimum,
+ * a profile built for them fails to compile.
+ */
+#define BQ25895_CHEM_LICOO2_4V2         4208, BQ25895_BATLOWV_3000MV, BQ25895_VRECHG_100MV, 50, 5
+#define BQ25895_CHEM_NMC_4V1            4096, BQ25895_BATLOWV_3000MV, BQ25895_VRECHG_100MV, 50, 5
+#define BQ25895_CHEM_LIHV_4V35          4352, BQ25895_BATLOWV_3000MV, BQ25895_VRECHG_100MV, 50, 5
+#define BQ25895_CHEM_LIHV_4V4           4400, BQ25895_BATLOWV_3000MV, BQ25895_VRECHG_100MV, 50, 5
+#define BQ25895_CHEM_LIPO_FAST_4V2      4208, BQ25895_BATLOWV_3000MV, BQ25895_VRECHG_200MV, 100, 5
+
+/*---------------------------------------- PROFILE MACROS ---------------------------------------*/
+/* Value rounded down to the field step, clamped to at least the field base */
+#define BQ25895_PROFILE_STEP(value, field)                                                          \
+    (((value) < BQ25895_##field##_BASE) ? BQ25895_##field##_BASE                                    \
+    : ((((value) - BQ25895_##field##_BASE) / BQ25895_##field##_LSB) * BQ25895_##field##_LSB + BQ25895_##field##_BASE))
+
+#define BQ25895_PROFILE_FIELD_MAX(field)                                                            \
+    (BQ25895_##field##_BASE + (BQ25895_##field##_MASK >> BQ25895_##field##_BIT) * BQ25895_##field##_LSB)
+
+#define BQ25895_PROFILE_ICHG(mah, chg_pct)      BQ25895_PROFILE_STEP((uint32_t)(mah) * (chg_pct) / 100, ICHG)
+#define BQ25895_PROFILE_ITERM(mah, term_pct)    BQ25895_PROFILE_STEP((uint32_t)(mah) * (term_pct) / 100, ITERM)
+
+/* Raw REG_04..REG_07 images, EN_PUMPX off, STAT pin enabled, JEITA_ISET 20% */
+#define BQ25895_PROFILE_REGS(mah, vreg_mv, batlowv, vrechg, chg_pct, term_pct)                      \
+    {                                                                                               \
+        BQ25895_ENCODE(BQ25895_PROFILE_ICHG(mah, chg_pct), ICHG),                                   \
+        BQ25895_ENCODE(BQ25895_PROFILE_ITERM(mah, term_pct), IPRECHG)                               \
+                | BQ25895_ENCODE(BQ25895_PROFILE_ITERM(mah, term_pct), ITERM),                      \
+        BQ25895_ENCODE(vreg_mv, VREG) | ((batlowv) << BQ25895_BATLOWV_BIT)                          \
+                | ((vrechg) << BQ25895_VRECHG_BIT),                                                 \
+        (BQ25895_ENABLED << BQ25895_EN_TERM_BIT)                                                    \
+                | (BQ25895_PROFILE_WATCHDOG << BQ25895_WATCHDOG_BIT)                                \
+                | (BQ25895_ENABLED << BQ25895_EN_TIMER_BIT)                                         \
+                | (BQ25895_PROFILE_CHG_TIMER << BQ25895_CHG_TIMER_BIT)                              \
+                | (1 << BQ25895_JEITA_ISET_BIT)                                                     \
+    }
+
+#define BQ25895_PROFILE_DEFINE_(id, mah, vreg_mv, batlowv, vrechg, chg_pct, term_pct)               \
+    _Static_assert((vreg_mv) >= BQ25895_VREG_BASE && (vreg_mv) <= BQ25895_PROFILE_VREG_MAX_MV,      \
+            #id ": VREG out of range");                                                             \
+    _Static_assert(((vreg_mv) - BQ25895_VREG_BASE) % BQ25895_VREG_LSB == 0,                         \
+            #id ": VREG not a multiple of the 16mV step");                                          \
+    _Static_assert(BQ25895_PROFILE_ICHG(mah, chg_pct) <= BQ25895_PROFILE_ICHG_MAX_MA,               \
+            #id ": ICHG out of range");                                                             \
+    _Static_assert(BQ25895_PROFILE_ICHG(mah, chg_pct) >= BQ25895_PROFILE_ICHG_MIN_MA,               \
+            #id ": ICHG rounds to 0, charging would be disabled");                                  \
+    _Static_assert(BQ25895_PROFILE_ICHG(mah, chg_pct) > BQ25895_PROFILE_ITERM(mah, term_pct),       \
+            #id ": ICHG not above ITERM, charging would terminate at once");                        \
+    _Static_assert(BQ25895_PROFILE_ITERM(mah, term_pct) <= BQ25895_PROFILE_FIELD_MAX(IPRECHG),      \
+            #id ": IPRECHG out of range");                                                          \
+    _Static_assert(BQ25895_PROFILE_ITERM(mah, term_pct) <= BQ25895_PROFILE_FIELD_MAX(ITERM),        \
+            #id ": ITERM out of range");                                                            \
+    const BQ25895_PROFILE id = {                                                                    \
+        .name = #id,                                                                                \
+        .regs = BQ25895_PROFILE_REGS(mah, vreg_mv, batlowv, vrechg, chg_pct, term_pct)              \
+    }
+
+/*
+ * Define a profile at file scope, checked by the compiler:
+ *     BQ25895_PROFILE_DEFINE(pack_profile, BQ25895_CHEM_LIHV_4V35, 3000);
+ */
+#define BQ25895_PROFILE_DEFINE_X(id, mah, ...)    BQ25895_PROFILE_DEFINE_(id, mah, __VA_ARGS__)
+#define BQ25895_PROFILE_DEFINE(id, chemistry, mah) BQ25895_PROFILE_DEFINE_X(id, mah, chemistry)
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_PROFILE {
+    const char *name;
+    uint8_t regs[BQ25895_PROFILE_LEN];  /**< Raw REG_04..REG_07 images */
+} BQ25895_PROFILE;
+
+/*------------------------------------ PROFILES -------------------------------------------------*/
+extern const BQ25895_PROFILE BQ25895_PROFILE_LICOO2_4V2;
+extern const BQ25895_PROFILE BQ25895_PROFILE_NMC_4V1;
+extern const BQ25895_PROFILE BQ25895_PROFILE_LIHV_4V35;
+extern const BQ25895_PROFILE BQ25895_PROFILE_LIHV_4V4;
+extern const BQ25895_PROFILE BQ25895_PROFILE_LIPO_FAST_4V2;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_ProfileApply(const BQ25895_PROFILE *profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_PROFILE_H */
@@ -0,0 +1,79 @@
+/**
+ *  @brief     Pump Express adapter voltage negotiation for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_PUMPX_H
+#define BQ25895_PUMPX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_PUMPX_MAX_MV            12000
+#define BQ25895_PUMPX_MIN_RISE_MV       500
+#define BQ25895_PUMPX_MIN_GAIN_PCT      5
+#define BQ25895_PUMPX_PERIOD_MS         1000
+#define BQ25895_PUMPX_SETTLE_MS         500
+#define BQ25895_PUMPX_PULSE_TIMEOUT_MS  2000
+#define BQ25895_PUMPX_PULSE_POLL_MS     50
+#define BQ25895_PUMPX_MAX_RETRIES       2
+#define BQ25895_PUMPX_BACKOFF_MS        30000
+#define BQ25895_PUMPX_MIN_VBUS_MV       4000    /* Below this the adapter is considered unplugged */
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_PUMPX_PHASE {
+    BQ25895_PUMPX_MEASURE,          /**< Measure charge power at the present adapter voltage */
+    BQ25895_PUMPX_PULSE,            /**< Wait for PUMPX_UP/PUMPX_DN to clear after the pulse sequence */
+    BQ25895_PUMPX_SETTLE,           /**< Let VBUS and the charge current settle, then judge the step */
+    BQ25895_PUMPX_HOLD              /**< Settled on the best voltage, watch for VDPM, IDPM and unplug */
+} BQ25895_PUMPX_PHASE;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_PUMPX_CONFIG {
+    uint16_t max_mv;                /**< Highest adapter voltage to ask for */
+    uint16_t min_rise_mv;           /**< VBUS has to rise by this much for a step up to count as accepted */
+    uint8_t min_gain_pct;           /**< Charge power has to improve by this much to keep a step up */
+    uint8_t max_retries;            /**< Unanswered step up requests before backing off */
+    uint32_t period_ms;             /**< Measurement period while climbing and holding */
+    uint32_t settle_ms;
+    uint32_t pulse_timeout_ms;
+    uint32_t pulse_poll_ms;         /**< REG_09 poll period while a pulse sequence runs */
+    uint32_t backoff_ms;            /**< First back off time, doubled on every failed attempt */
+} BQ25895_PUMPX_CONFIG;
+
+typedef struct BQ25895_PUMPX {
+    BQ25895_PUMPX_CONFIG config;
+    BQ25895_PUMPX_PHASE phase;
+    uint8_t pending;                /**< PUMPX_UP or PUMPX_DN mask to write, 0 if none */
+    uint8_t request;                /**< Last requested step, PUMPX_UP or PUMPX_DN mask */
+    uint8_t retries;
+    uint8_t climbed;                /**< A step up was requested since the adapter was plugged in */
+    uint8_t level;                  /**< Accepted step ups above the plug-in voltage */
+    uint8_t best_level;
+    uint16_t vbus_mv;
+    uint16_t step_vbus_mv;          /**< VBUS before the last step request */
+    uint32_t power_mw;              /**< Charge power (VBAT x ICHGR) of the last measurement */
+    uint32_t best_power_mw;
+    uint32_t backoff_ms;
+    uint32_t tick;
+    uint32_t poll_tick;             /**< Last REG_09 poll of the present pulse sequence */
+    uint32_t hold_tick;             /**< Start of the present hold, times the back off */
+} BQ25895_PUMPX;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_PumpXStart(BQ25895_PUMPX *px, const BQ25895_PUMPX_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_PumpXStep(BQ25895_PUMPX *px);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_PUMPX_H */
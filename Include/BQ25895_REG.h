@@ -134,7 +134,7 @@ extern "C" {
 #define BQ25895_EN_TERM_MASK        0x80
 #define BQ25895_EN_TERM_BIT         7
 
-#define BQ25895_STAT_DIS_MASK       0x04
+#define BQ25895_STAT_DIS_MASK       0x40
 #define BQ25895_STAT_DIS_BIT        6
 
 #define BQ25895_WATCHDOG_MASK       0x30
@@ -146,6 +146,9 @@ extern "C" {
 #define BQ25895_CHG_TIMER_MASK      0x06
 #define BQ25895_CHG_TIMER_BIT       1
 
+#define BQ25895_JEITA_ISET_MASK     0x01
+#define BQ25895_JEITA_ISET_BIT      0
+
 /*---------- Register 0x08 ----------*/
 #define BQ25895_REG_08              0x08
 
@@ -319,6 +322,14 @@ extern "C" {
 #define BQ25895_DEV_REV_BIT       0
 
 /*------------------------------------ CONTROL REGISTERS BITFIELDS------------------------------------*/
+#define BQ25895_GET_FIELD(reg_val, field)   (((reg_val) & BQ25895_##field##_MASK) >> BQ25895_##field##_BIT)
+#define BQ25895_SET_FIELD(reg_val, field, value) \
+    (((reg_val) & ~BQ25895_##field##_MASK) | (((value) << BQ25895_##field##_BIT) & BQ25895_##field##_MASK))
+
+#define BQ25895_DECODE(reg_val, field) \
+    ((BQ25895_GET_FIELD(reg_val, field) * BQ25895_##field##_LSB) + BQ25895_##field##_BASE)
+#define BQ25895_ENCODE(value, field) \
+    (((((value) - BQ25895_##field##_BASE) / BQ25895_##field##_LSB) << BQ25895_##field##_BIT) & BQ25895_##field##_MASK)
 
 /*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
 typedef enum BQ25895_STATE {
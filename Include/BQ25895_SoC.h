@@ -0,0 +1,56 @@
+/**
+ *  @brief     Coulomb counting and OCV fusion state-of-charge estimator for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_SOC_H
+#define BQ25895_SOC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_SOC_REST_CURRENT_MA     50      /* One ICHGR LSB */
+#define BQ25895_SOC_REST_TIME_MS        600000  /* 10 minutes before OCV is trusted */
+#define BQ25895_SOC_OCV_GAIN_Q16        655     /* 1% of the OCV error corrected per update */
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_SOC_CONFIG {
+    uint16_t capacity_mah;          /**< Usable battery capacity */
+    uint16_t rest_current_ma;       /**< Battery current at or below this is treated as rest */
+    uint32_t rest_time_ms;          /**< Time at rest before the OCV correction is applied */
+    uint16_t ocv_gain_q16;          /**< Complementary filter gain towards the OCV estimate, Q16 */
+} BQ25895_SOC_CONFIG;
+
+typedef struct BQ25895_SOC {
+    BQ25895_SOC_CONFIG config;
+    int32_t charge_mas;             /**< Charge above empty in mAs */
+    int32_t capacity_mas;
+    int32_t mas_per_permille;       /**< Charge per 0.1% of state of charge */
+    int32_t residue_mams;           /**< Sub mAs remainder of the integration, in mAms */
+    uint32_t last_ms;
+    uint32_t rest_ms;               /**< Time spent at rest so far */
+    uint8_t valid;                  /**< Non-zero once seeded from the first sample */
+} BQ25895_SOC;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_SoCInit(BQ25895_SOC *soc, const BQ25895_SOC_CONFIG *config);
+
+void BQ25895_SoCUpdate(BQ25895_SOC *soc, int16_t current_ma, uint16_t voltage_mv, uint32_t now_ms);
+
+uint16_t BQ25895_SoCGet(const BQ25895_SOC *soc);
+
+uint16_t BQ25895_SoCFromOCV(uint16_t voltage_mv);
+
+int32_t BQ25895_SoCIntegrate(int32_t *residue_mams, int32_t current_ma, uint32_t dt_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_SOC_H */
@@ -0,0 +1,80 @@
+/**
+ *  @brief     State-of-health tracking from charge cycle fingerprints for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_SOH_H
+#define BQ25895_SOH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+#include "BQ25895_SoC.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#ifndef BQ25895_SOH_HISTORY
+#define BQ25895_SOH_HISTORY             8       /* Cycles kept in the summary ring */
+#endif
+#define BQ25895_SOH_CV_MARGIN_MV        (2 * BQ25895_BATV_LSB)
+#define BQ25895_SOH_MAX_START_SOC       500     /* Capacity is only estimated from cycles starting below 50% */
+#define BQ25895_SOH_WEIGHT_Q8           64      /* 0.25 per new capacity estimate */
+
+/*------------------------------------ ENUM DEFINATIONS -----------------------------------------*/
+typedef enum BQ25895_SOH_END {
+    BQ25895_SOH_TERMINATED,         /**< Charge ended with CHRG_STAT = charge termination done */
+    BQ25895_SOH_ABORTED             /**< Charge stopped before termination (unplug, fault, disable) */
+} BQ25895_SOH_END;
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_SOH_CYCLE {
+    uint32_t cc_s;                  /**< Time in pre-charge and constant current */
+    uint32_t cv_s;                  /**< Time in constant voltage */
+    uint16_t charge_mah;            /**< Charge delivered during the cycle */
+    uint16_t capacity_mah;          /**< Estimated full capacity, 0 if the cycle could not be used */
+    uint16_t start_mv;              /**< Rested battery voltage before the cycle */
+    uint16_t end_ma;                /**< Charge current when the cycle ended */
+    BQ25895_SOH_END end;
+} BQ25895_SOH_CYCLE;
+
+typedef struct BQ25895_SOH_CONFIG {
+    uint16_t design_capacity_mah;
+    uint16_t vreg_mv;               /**< Charge voltage, BATV within BQ25895_SOH_CV_MARGIN_MV of it counts as CV */
+} BQ25895_SOH_CONFIG;
+
+typedef struct BQ25895_SOH {
+    BQ25895_SOH_CONFIG config;
+    BQ25895_SOH_CYCLE ring[BQ25895_SOH_HISTORY];
+    uint8_t head;                   /**< Next slot to write */
+    uint8_t count;
+    uint8_t active;                 /**< Non-zero while a charge cycle is being recorded */
+    BQ25895_SOH_CYCLE cycle;        /**< Cycle in progress */
+    uint32_t charge_mas;
+    int32_t residue_mams;
+    uint16_t idle_mv;               /**< Last battery voltage seen while not charging */
+    uint16_t last_ma;
+    uint32_t last_ms;
+    uint16_t soh_permille;          /**< Smoothed capacity relative to design capacity */
+} BQ25895_SOH;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+void BQ25895_SoHInit(BQ25895_SOH *soh, const BQ25895_SOH_CONFIG *config);
+
+void BQ25895_SoHUpdate(BQ25895_SOH *soh, BQ25895_CHRG_STAT state, uint16_t current_ma, uint16_t voltage_mv,
+        uint32_t now_ms);
+
+const BQ25895_SOH_CYCLE *BQ25895_SoHGetCycle(const BQ25895_SOH *soh, uint8_t age);
+
+uint16_t BQ25895_SoHGet(const BQ25895_SOH *soh);
+
+int16_t BQ25895_SoHGetTrend(const BQ25895_SOH *soh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_SOH_H */
@@ -0,0 +1,67 @@
+/**
+ *  @brief     Thermal-aware charge current governor for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifndef BQ25895_THERMALGOVERNOR_H
+#define BQ25895_THERMALGOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895.h"
+
+/*---------------------------------------- DEFAULT SETTINGS -------------------------------------*/
+#define BQ25895_TG_ICHG_MAX_MA          2048
+#define BQ25895_TG_ICHG_MIN_MA          512
+#define BQ25895_TG_DERATE_START_PCT     3550    /* TSPCT 35.50%, roughly 58C with a 103AT NTC */
+#define BQ25895_TG_DERATE_END_PCT       3440    /* TSPCT 34.40%, TS hot (VT5), roughly 60C */
+#define BQ25895_TG_TREG_BACKOFF_Q8      224     /* 0.875 x ICHG per period in thermal regulation */
+#define BQ25895_TG_RECOVER_STEP_MA      16
+#define BQ25895_TG_SLEW_DOWN_MA         256
+#define BQ25895_TG_DEADBAND_MA          256
+#define BQ25895_TG_PERIOD_MS            1000
+
+/*------------------------------------ STRUCT DEFINATIONS ---------------------------------------*/
+typedef struct BQ25895_TG_CONFIG {
+    uint16_t ichg_max_ma;           /**< Charge current when cool */
+    uint16_t ichg_min_ma;           /**< Charge current at and beyond derate_end_pct */
+    uint16_t derate_start_pct;      /**< TSPCT (x100) where derating starts, lower TSPCT is hotter */
+    uint16_t derate_end_pct;        /**< TSPCT (x100) where derating reaches ichg_min_ma */
+    uint16_t treg_backoff_q8;       /**< Multiplicative decrease while THERM_STAT is set, Q8 (256 = 1.0) */
+    uint16_t recover_step_ma;       /**< Additive increase per period once out of thermal regulation */
+    uint16_t slew_down_ma;          /**< Largest decrease per period caused by the TS derating curve */
+    uint16_t deadband_ma;           /**< Smallest ICHG change written outside thermal regulation */
+    uint32_t period_ms;
+} BQ25895_TG_CONFIG;
+
+typedef struct BQ25895_THERMAL_GOVERNOR {
+    BQ25895_TG_CONFIG config;
+    uint8_t pending;                /**< Non-zero when ichg_ma has to be written */
+    BQ25895_THERM_STAT therm_stat;
+    BQ25895_NTC_FAULT ntc_fault;
+    uint16_t ts_pct;
+    uint16_t ceiling_ma;            /**< Die temperature (TREG) limited current */
+    uint8_t hold;                   /**< Periods left before the ceiling may rise again */
+    uint8_t hold_len;               /**< Hold after the last TREG back off, doubled on every hit */
+    uint16_t level_ma;              /**< Controller output, ichg_ma follows it outside the deadband */
+    uint16_t ichg_ma;               /**< Last commanded charge current */
+    uint32_t tick;
+} BQ25895_THERMAL_GOVERNOR;
+
+/*------------------------------------ FUNCTION DEFINATIONS -------------------------------------*/
+HAL_StatusTypeDef BQ25895_ThermalGovernorStart(BQ25895_THERMAL_GOVERNOR *tg, const BQ25895_TG_CONFIG *config);
+
+HAL_StatusTypeDef BQ25895_ThermalGovernorStep(BQ25895_THERMAL_GOVERNOR *tg);
+
+uint16_t BQ25895_ThermalGovernorTarget(const BQ25895_THERMAL_GOVERNOR *tg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BQ25895_THERMALGOVERNOR_H */
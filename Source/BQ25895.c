@@ -12,7 +12,92 @@ extern "C" {
 #include "main.h"
 #include "BQ25895.h"
 
-static I2C_HandleTypeDef *BQ25895_device;
+static BQ25895_BUS BQ25895_bus;
+static BQ25895_BUS_DEVICE BQ25895_default_device;
+static BQ25895_SHADOW BQ25895_default_shadow;
+static volatile BQ25895_FAULT_HOOK BQ25895_fault_hook;
+/* One lock per register address, shared by all devices, serialising read-modify-write cycles */
+static BQ25895_LOCK BQ25895_reg_lock[BQ25895_REG_COUNT];
+
+/**
+ * @brief Device the calling context selected, the BQ25895_Init() device if it never selected one.
+ */
+static const BQ25895_BUS_DEVICE *BQ25895_Selected(void) {
+    const BQ25895_BUS_DEVICE *device = (const BQ25895_BUS_DEVICE *) BQ25895_LockGetLocal();
+    return (device != NULL) ? device : &BQ25895_default_device;
+}
+
+/**
+ * @brief Scheduling class of a register access: status and fault reads first, ADC reads last.
+ */
+static BQ25895_BUS_PRIORITY BQ25895_Priority(uint8_t reg, BQ25895_BUS_DIR dir) {
+    if (dir == BQ25895_BUS_WRITE)
+        return BQ25895_BUS_CONTROL;
+    if (reg == BQ25895_REG_0B || reg == BQ25895_REG_0C)
+        return BQ25895_BUS_FAULT;
+    if (reg >= BQ25895_REG_0E && reg <= BQ25895_REG_13)
+        return BQ25895_BUS_TELEMETRY;
+    return BQ25895_BUS_CONTROL;
+}
+
+/**
+ * @brief Report a read fault register and keep the register cache of the device up to date.
+ * @note Cache bytes are plain stores so readers never wait on the bus or a lock.
+ */
+static void BQ25895_Complete(const BQ25895_BUS_DEVICE *device, BQ25895_BUS_DIR dir, uint8_t reg,
+        const uint8_t *data, uint16_t len) {
+    uint16_t i;
+    BQ25895_FAULT_HOOK hook = BQ25895_fault_hook;
+    /* REG_0C latches a fault until it is read, report it before it is gone */
+    if (dir == BQ25895_BUS_READ && reg <= BQ25895_REG_0C && reg + len > BQ25895_REG_0C) {
+        if (hook != NULL)
+            hook(device, data[BQ25895_REG_0C - reg]);
+        BQ25895_FaultCallback(device, data[BQ25895_REG_0C - reg]);
+    }
+    if (device->shadow == NULL)
+        return;
+    for (i = 0; i < len && reg + i < BQ25895_REG_COUNT; i++) {
+        device->shadow->regs[reg + i] = data[i];
+        device->shadow->valid |= 1UL << (reg + i);
+    }
+    /* REG_RST restores every register to its default behind the cache */
+    if (dir == BQ25895_BUS_WRITE && reg <= BQ25895_REG_14 && reg + len > BQ25895_REG_14
+            && (data[BQ25895_REG_14 - reg] & BQ25895_RESET_MASK))
+        device->shadow->valid = 0;
+}
+
+/**
+ * @brief Register transfer to a given device, keeping its register cache up to date.
+ */
+static HAL_StatusTypeDef BQ25895_Transfer(const BQ25895_BUS_DEVICE *device, BQ25895_BUS_DIR dir, uint8_t reg,
+        uint8_t *data, uint16_t len) {
+    HAL_StatusTypeDef status;
+    status = BQ25895_BusTransfer(device, BQ25895_Priority(reg, dir), dir, reg, data, len);
+    if (status == HAL_OK)
+        BQ25895_Complete(device, dir, reg, data, len);
+    return status;
+}
+
+/**
+ * @brief Called with the REG_0C contents every time the driver reads the fault register.
+ * @param[in] *device Device the register was read from.
+ * @param[in] fault REG_0C value, 0 when no fault is present.
+ * @note Runs in the context of the read, keep it short. Override to log or react to faults.
+ */
+__weak void BQ25895_FaultCallback(const BQ25895_BUS_DEVICE *device, uint8_t fault) {
+    (void) device;
+    (void) fault;
+}
+
+/**
+ * @brief Install a library hook called with REG_0C on every fault register read, before BQ25895_FaultCallback().
+ * @param[in] hook Hook or NULL to remove it.
+ * @note For driver modules such as BQ25895_FaultLog, so the weak BQ25895_FaultCallback() stays free for the
+ * application. There is one hook, set it once at start up.
+ */
+void BQ25895_SetFaultHook(BQ25895_FAULT_HOOK hook) {
+    BQ25895_fault_hook = hook;
+}
 
 
 /**
@@ -99,8 +184,7 @@ HAL_StatusTypeDef BQ25895_GetInputCurrentLimit(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_00, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_IINLIM_MASK) >> BQ25895_IINLIM_BIT;
-    *current_ma = (temp * BQ25895_IINLIM_LSB) + BQ25895_IINLIM_BASE;
+    *current_ma = BQ25895_DECODE(temp, IINLIM);
     return status;
 }
 
@@ -188,8 +272,7 @@ HAL_StatusTypeDef BQ25895_GetInputVoltageLimitOffset(uint16_t *offset) {
     status = BQ25895_ReadRegister(BQ25895_REG_01, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_VINDPMOS_MASK) >> BQ25895_VINDPMOS_BIT;
-    *offset = (temp * BQ25895_VINDPMOS_LSB) + BQ25895_VINDPMOS_BASE;
+    *offset = BQ25895_DECODE(temp, VINDPMOS);
     return status;
 }
 
@@ -556,8 +639,7 @@ HAL_StatusTypeDef BQ25895_GetSysMinVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_03, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_SYS_MINV_MASK) >> BQ25895_SYS_MINV_BIT;
-    *voltage_mv = (temp * BQ25895_SYS_MINV_LSB) + BQ25895_SYS_MINV_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, SYS_MINV);
     return status;
 }
 
@@ -620,8 +702,7 @@ HAL_StatusTypeDef BQ25895_GetFastChargeCurrent(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_04, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_ICHG_MASK) >> BQ25895_ICHG_BIT;
-    *current_ma = (temp * BQ25895_ICHG_LSB) + BQ25895_ICHG_BASE;
+    *current_ma = BQ25895_DECODE(temp, ICHG);
     return status;
 }
 
@@ -651,8 +732,7 @@ HAL_StatusTypeDef BQ25895_GetPreChargeCurrent(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_05, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_IPRECHG_MASK) >> BQ25895_IPRECHG_BIT;
-    *current_ma = (temp * BQ25895_IPRECHG_LSB) + BQ25895_IPRECHG_BASE;
+    *current_ma = BQ25895_DECODE(temp, IPRECHG);
     return status;
 }
 
@@ -682,8 +762,7 @@ HAL_StatusTypeDef BQ25895_GetTermChargeCurrent(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_05, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_ITERM_MASK) >> BQ25895_ITERM_BIT;
-    *current_ma = (temp * BQ25895_ITERM_LSB) + BQ25895_ITERM_BASE;
+    *current_ma = BQ25895_DECODE(temp, ITERM);
     return status;
 }
 
@@ -715,8 +794,7 @@ HAL_StatusTypeDef BQ25895_GetChargeVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_06, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_VREG_MASK) >> BQ25895_VREG_BIT;
-    *voltage_mv = (temp * BQ25895_VREG_LSB) + BQ25895_VREG_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, VREG);
     return status;
 }
 
@@ -951,8 +1029,7 @@ HAL_StatusTypeDef BQ25895_GetIRCompResistance(uint8_t *ohms_mohm) {
     status = BQ25895_ReadRegister(BQ25895_REG_08, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_BAT_COMP_MASK) >> BQ25895_BAT_COMP_BIT;
-    *ohms_mohm = (temp * BQ25895_BAT_COMP_LSB) + BQ25895_BAT_COMP_BASE;
+    *ohms_mohm = BQ25895_DECODE(temp, BAT_COMP);
     return status;
 }
 
@@ -982,8 +1059,7 @@ HAL_StatusTypeDef BQ25895_GetIRCompVoltage(uint8_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_08, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_VCLAMP_MASK) >> BQ25895_VCLAMP_BIT;
-    *voltage_mv = (temp * BQ25895_VCLAMP_LSB) + BQ25895_VCLAMP_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, VCLAMP);
     return status;
 }
 
@@ -1236,8 +1312,7 @@ HAL_StatusTypeDef BQ25895_GetBoostModeVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_0A, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_BOOSTV_MASK) >> BQ25895_BOOSTV_BIT;
-    *voltage_mv = (temp * BQ25895_BOOSTV_LSB) + BQ25895_BOOSTV_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, BOOSTV);
     return status;
 }
 
@@ -1435,12 +1510,13 @@ HAL_StatusTypeDef BQ25895_GetForceVINDPM(BQ25895_FORCE_VINDPM *state) {
  * @note Register is read only when FORCE_VINDPM=0 and can be written by internal control based on relative VINDPM threshold setting. Register can be read/write when FORCE_VINDPM = 1
  */
 HAL_StatusTypeDef BQ25895_SetAbsoluteVINPDMTh(uint16_t *voltage_mv) {
-    uint16_t temp;
-    if (*voltage_mv < 3900 )
-        temp = 3900;
-    temp = (temp - BQ25895_VINDPM_BASE) / BQ25895_VINDPM_LSB;
+    uint16_t voltage = *voltage_mv;
+    uint8_t temp;
+    if (voltage < 3900 )
+        voltage = 3900;
+    temp = (voltage - BQ25895_VINDPM_BASE) / BQ25895_VINDPM_LSB;
     temp <<= BQ25895_VINDPM_BIT;
-    return BQ25895_UpdateBits(BQ25895_REG_0D, BQ25895_VINDPM_MASK, (uint8_t *)&temp);
+    return BQ25895_UpdateBits(BQ25895_REG_0D, BQ25895_VINDPM_MASK, &temp);
 }
 
 /**
@@ -1458,8 +1534,7 @@ HAL_StatusTypeDef BQ25895_GetAbsoluteVINPDMTh(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_0D, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_VINDPM_MASK) >> BQ25895_VINDPM_BIT;
-    *voltage_mv = (temp * BQ25895_VINDPM_LSB) + BQ25895_VINDPM_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, VINDPM);
     return status;
 }
 
@@ -1490,8 +1565,7 @@ HAL_StatusTypeDef BQ25895_GetBatteryVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_0E, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_BATV_MASK) >> BQ25895_BATV_BIT;
-    *voltage_mv = (temp * BQ25895_BATV_LSB) + BQ25895_BATV_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, BATV);
     return status;
 }
 
@@ -1507,8 +1581,7 @@ HAL_StatusTypeDef BQ25895_GetSystemVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_0F, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_SYSV_MASK) >> BQ25895_SYSV_BIT;
-    *voltage_mv = (temp * BQ25895_SYSV_LSB) + BQ25895_SYSV_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, SYSV);
     return status;
 }
 
@@ -1526,8 +1599,7 @@ HAL_StatusTypeDef BQ25895_GetTSVoltage(uint16_t *percent) {
     status = BQ25895_ReadRegister(BQ25895_REG_10, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_TSPCT_MASK) >> BQ25895_TSPCT_BIT;
-    *percent = (*percent * BQ25895_TSPCT_LSB) + BQ25895_TSPCT_BASE;
+    *percent = BQ25895_DECODE(temp, TSPCT);
     return status;
 }
 
@@ -1558,8 +1630,7 @@ HAL_StatusTypeDef BQ25895_GetVBUSVoltage(uint16_t *voltage_mv) {
     status = BQ25895_ReadRegister(BQ25895_REG_11, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_VBUSV_MASK) >> BQ25895_VBUSV_BIT;
-    *voltage_mv = (temp * BQ25895_VBUSV_LSB) + BQ25895_VBUSV_BASE;
+    *voltage_mv = BQ25895_DECODE(temp, VBUSV);
     return status;
 }
 
@@ -1576,8 +1647,7 @@ HAL_StatusTypeDef BQ25895_GetChargeCurrent(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_12, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_ICHGR_MASK) >> BQ25895_ICHGR_BIT;
-    *current_ma = (temp * BQ25895_ICHGR_LSB) + BQ25895_ICHGR_BASE;
+    *current_ma = BQ25895_DECODE(temp, ICHGR);
     return status;
 }
 
@@ -1622,8 +1692,7 @@ HAL_StatusTypeDef BQ25895_GetICO_IIDPMCurrent(uint16_t *current_ma) {
     status = BQ25895_ReadRegister(BQ25895_REG_13, &temp);
     if (status != HAL_OK)
         return status;
-    temp = (temp & BQ25895_IDPM_LIM_MASK) >> BQ25895_IDPM_LIM_BIT;
-    *current_ma = (temp * BQ25895_IDPM_LIM_LSB) + BQ25895_IDPM_LIM_BASE;
+    *current_ma = BQ25895_DECODE(temp, IDPM_LIM);
     return status;
 }
 
@@ -1698,8 +1767,62 @@ HAL_StatusTypeDef BQ25895_GetDevRev(uint8_t *rev) {
     return status;
 }
 
+/**
+ * @brief Initialise the driver for a single BQ25895 on its own bus.
+ * @param[in] *i2cHandle I2C peripheral the BQ25895 is connected to.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note For several devices or a bus shared with other drivers, set up a #BQ25895_BUS and one
+ * #BQ25895_BUS_DEVICE per charger and pick the target with BQ25895_SelectDevice() afterwards.
+ * Call before other tasks use the driver, it also creates the register locks.
+ */
 HAL_StatusTypeDef BQ25895_Init(I2C_HandleTypeDef *i2cHandle) {
-    BQ25895_device = i2cHandle;
+    HAL_StatusTypeDef status;
+    uint8_t reg;
+    for (reg = 0; reg < BQ25895_REG_COUNT; reg++) {
+        status = BQ25895_LockInit(&BQ25895_reg_lock[reg]);
+        if (status != HAL_OK)
+            return status;
+    }
+    BQ25895_BusInit(&BQ25895_bus, i2cHandle, BQ25895_BUS_DEFAULT_HZ);
+    BQ25895_default_device.bus = &BQ25895_bus;
+    BQ25895_default_device.addr = BQ25895_I2C_ADDR;
+    BQ25895_default_shadow.valid = 0;
+    BQ25895_default_device.shadow = &BQ25895_default_shadow;
+    return HAL_OK;
+}
+
+/**
+ * @brief Select the BQ25895 the following driver calls of the calling thread or task talk to.
+ * @param[in] *device Device descriptor, must stay valid while selected. NULL selects the BQ25895_Init() device.
+ * @note The selection is kept per context (see BQ25895_LockSetLocal()), so tasks driving different
+ * chargers do not race each other. Contexts that never select talk to the BQ25895_Init() device.
+ */
+void BQ25895_SelectDevice(const BQ25895_BUS_DEVICE *device) {
+    BQ25895_LockSetLocal((void *) device);
+}
+
+/**
+ * @brief Get the BQ25895 driver calls of the calling context currently talk to.
+ * @retval Device descriptor
+ */
+const BQ25895_BUS_DEVICE *BQ25895_GetSelectedDevice(void) {
+    return BQ25895_Selected();
+}
+
+/**
+ * @brief Get the last value read from or written to a register of the selected device, without bus access.
+ * @param[in] reg Register address.
+ * @param[out] *data Cached register value.
+ * @retval HAL_StatusTypeDef HAL_ERROR if the device has no register cache or the register was not accessed yet
+ * @note Never blocks. Holds what the device returned or was sent, self clearing bits (CONV_START,
+ * FORCE_ICO, WD_RST...) are not tracked after they clear. The BQ25895_Init() device always has a cache.
+ */
+HAL_StatusTypeDef BQ25895_GetCachedRegister(uint8_t reg, uint8_t *data) {
+    const BQ25895_BUS_DEVICE *device = BQ25895_Selected();
+    if (device->shadow == NULL || reg >= BQ25895_REG_COUNT || !(device->shadow->valid & (1UL << reg)))
+        return HAL_ERROR;
+    *data = device->shadow->regs[reg];
+    return HAL_OK;
 }
 
 
@@ -1711,14 +1834,99 @@ HAL_StatusTypeDef BQ25895_Init(I2C_HandleTypeDef *i2cHandle) {
  * @return HAL_StatusTypeDef variable describing if it was successful or not.
  */
 HAL_StatusTypeDef BQ25895_UpdateBits(uint8_t reg, uint8_t mask, uint8_t *data) {
-    HAL_StatusTypeDef status;
-    uint8_t temp;
-    status = BQ25895_ReadRegister(reg, &temp);
-    if (status != HAL_OK)
-        return status;
-    temp &= ~mask;
-    temp |= *data & mask;
-    return BQ25895_WriteRegister(reg, &temp);
+    return BQ25895_DeviceUpdateBits(BQ25895_Selected(), reg, mask, data);
+}
+
+/**
+ * @brief BQ25895_UpdateBits() on a given device, independent of the selection.
+ * @param[in] *device Device descriptor.
+ * @param[in] reg Register address to write to.
+ * @param[in] mask Data mask.
+ * @param[in] *data Pointer to a date variable.
+ * @return HAL_StatusTypeDef variable describing if it was successful or not.
+ * @note Returns HAL_BUSY with #BQ25895_LOCK_CRITICAL when an interrupt preempted another access to the
+ * register or the bus, retry it outside the interrupt.
+ */
+HAL_StatusTypeDef BQ25895_DeviceUpdateBits(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t mask,
+        uint8_t *data) {
+    HAL_StatusTypeDef status;
+    uint8_t temp;
+    if (reg >= BQ25895_REG_COUNT)
+        return HAL_ERROR;
+    /* Two tasks updating different fields of one register must not lose each other's write */
+    if (BQ25895_LockTake(&BQ25895_reg_lock[reg]) != HAL_OK)
+        return HAL_BUSY;
+    status = BQ25895_Transfer(device, BQ25895_BUS_READ, reg, &temp, 1);
+    if (status == HAL_OK) {
+        temp &= ~mask;
+        temp |= *data & mask;
+        status = BQ25895_Transfer(device, BQ25895_BUS_WRITE, reg, &temp, 1);
+    }
+    BQ25895_LockGive(&BQ25895_reg_lock[reg]);
+    return status;
+}
+
+/**
+ * @brief Queue a field update to be run later by BQ25895_RunQueuedUpdate().
+ * @param[in,out] *queue Update queue, zero initialised before first use.
+ * @param[in] reg Register address.
+ * @param[in] mask Bits to change.
+ * @param[in] value New bits, already shifted into place.
+ * @retval HAL_StatusTypeDef HAL_ERROR if the queue is full, the update is dropped
+ */
+HAL_StatusTypeDef BQ25895_QueueUpdate(BQ25895_UPDATE_QUEUE *queue, uint8_t reg, uint8_t mask, uint8_t value) {
+    if (queue->count >= BQ25895_UPDATE_QUEUE_LEN || reg >= BQ25895_REG_COUNT)
+        return HAL_ERROR;
+    queue->reg[queue->count] = reg;
+    queue->mask[queue->count] = mask;
+    queue->value[queue->count] = value;
+    queue->count++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Run the oldest queued update on the selected device, one bus transaction per call.
+ * @param[in,out] *queue Update queue.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not, HAL_OK if the queue is empty
+ * @note With a register cache the update is a single write of the cached register with the self clearing
+ * command bits dropped, taken under the register lock. A register not in the cache yet is read first and
+ * the update runs on the next call. Fields changed behind the driver, e.g. by a watchdog expiry, are written
+ * back as cached. Without a cache it falls back to BQ25895_UpdateBits(), a read and a write. A failed update stays queued and is retried on the next call. Updates run in queue order.
+ */
+HAL_StatusTypeDef BQ25895_RunQueuedUpdate(BQ25895_UPDATE_QUEUE *queue) {
+    const BQ25895_BUS_DEVICE *device = BQ25895_Selected();
+    HAL_StatusTypeDef status;
+    uint8_t i = queue->index;
+    uint8_t reg = queue->reg[i];
+    uint8_t cached;
+    uint8_t temp;
+    if (queue->count == 0)
+        return HAL_OK;
+    if (device->shadow == NULL) {
+        status = BQ25895_DeviceUpdateBits(device, reg, queue->mask[i], &queue->value[i]);
+    } else {
+        if (BQ25895_LockTake(&BQ25895_reg_lock[reg]) != HAL_OK)
+            return HAL_BUSY;
+        /* Every driver write goes through the cache, under the lock it matches the register */
+        cached = (device->shadow->valid & (1UL << reg)) != 0;
+        if (cached) {
+            temp = device->shadow->regs[reg] & ~BQ25895_COMMAND_MASK(reg);
+            temp = (temp & ~queue->mask[i]) | (queue->value[i] & queue->mask[i]);
+            status = BQ25895_Transfer(device, BQ25895_BUS_WRITE, reg, &temp, 1);
+        } else {
+            status = BQ25895_Transfer(device, BQ25895_BUS_READ, reg, &temp, 1);
+        }
+        BQ25895_LockGive(&BQ25895_reg_lock[reg]);
+        if (!cached)
+            return status;
+    }
+    if (status != HAL_OK)
+        return status;
+    if (++queue->index >= queue->count) {
+        queue->index = 0;
+        queue->count = 0;
+    }
+    return status;
 }
 
 /**
@@ -1728,8 +1936,7 @@ HAL_StatusTypeDef BQ25895_UpdateBits(uint8_t reg, uint8_t mask, uint8_t *data) {
  * @return HAL_StatusTypeDef variable describing if it was successful or not.
  */
 HAL_StatusTypeDef BQ25895_WriteRegister(uint8_t reg, uint8_t *data) {
-    return HAL_I2C_Mem_Write(BQ25895_device, BQ25895_I2C_ADDR, reg,
-    I2C_MEMADD_SIZE_8BIT, data, 1, BQ25895_TIMEOUT);
+    return BQ25895_Transfer(BQ25895_Selected(), BQ25895_BUS_WRITE, reg, data, 1);
 }
 
 /**
@@ -1739,8 +1946,110 @@ HAL_StatusTypeDef BQ25895_WriteRegister(uint8_t reg, uint8_t *data) {
  * @return HAL_StatusTypeDef variable describing if it was successful or not.
  */
 HAL_StatusTypeDef BQ25895_ReadRegister(uint8_t reg, uint8_t *data) {
-    return HAL_I2C_Mem_Read(BQ25895_device, BQ25895_I2C_ADDR, reg,
-    I2C_MEMADD_SIZE_8BIT, data, 1, BQ25895_TIMEOUT);
+    return BQ25895_Transfer(BQ25895_Selected(), BQ25895_BUS_READ, reg, data, 1);
+}
+
+/**
+ * @brief Reads consecutive BQ25895 registers in a single I2C transaction.
+ * @param[in] reg Address of the first register to read from.
+ * @param[out] *data Pointer to a buffer of at least len bytes to read to.
+ * @param[in] len Number of registers to read.
+ * @return HAL_StatusTypeDef variable describing if it was successful or not.
+ */
+HAL_StatusTypeDef BQ25895_ReadRegisters(uint8_t reg, uint8_t *data, uint16_t len) {
+    return BQ25895_Transfer(BQ25895_Selected(), BQ25895_BUS_READ, reg, data, len);
+}
+
+/**
+ * @brief BQ25895_ReadRegisters() on a given device, independent of the selection.
+ * @param[in] *device Device descriptor.
+ * @param[in] reg Address of the first register to read from.
+ * @param[out] *data Pointer to a buffer of at least len bytes to read to.
+ * @param[in] len Number of registers to read.
+ * @return HAL_StatusTypeDef variable describing if it was successful or not.
+ */
+HAL_StatusTypeDef BQ25895_DeviceRead(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t *data, uint16_t len) {
+    return BQ25895_Transfer(device, BQ25895_BUS_READ, reg, data, len);
+}
+
+/**
+ * @brief Writes consecutive BQ25895 registers in a single I2C transaction.
+ * @param[in] reg Address of the first register to write to.
+ * @param[in] *data Pointer to a buffer of len bytes to write from.
+ * @param[in] len Number of registers to write.
+ * @return HAL_StatusTypeDef variable describing if it was successful or not.
+ * @note Holds the locks of all written registers so no BQ25895_UpdateBits() cycle interleaves.
+ */
+HAL_StatusTypeDef BQ25895_WriteRegisters(uint8_t reg, uint8_t *data, uint16_t len) {
+    return BQ25895_DeviceWrite(BQ25895_Selected(), reg, data, len);
+}
+
+/**
+ * @brief Queue a register transfer on a given device without waiting for the bus.
+ * @param[out] *req Request, must stay valid until BQ25895_DevicePoll() stops returning HAL_BUSY.
+ * @param[in] *device Device descriptor.
+ * @param[in] dir #BQ25895_BUS_READ or #BQ25895_BUS_WRITE.
+ * @param[in] reg Address of the first register.
+ * @param[in,out] *data Buffer of len bytes, must stay valid like req.
+ * @param[in] len Number of registers.
+ * @return HAL_StatusTypeDef HAL_ERROR if the transfer is too long, nothing is queued then
+ * @note Not locked against BQ25895_UpdateBits(), use it for reads and whole register writes.
+ */
+HAL_StatusTypeDef BQ25895_DeviceSubmit(BQ25895_BUS_REQUEST *req, const BQ25895_BUS_DEVICE *device,
+        BQ25895_BUS_DIR dir, uint8_t reg, uint8_t *data, uint16_t len) {
+    if (len > BQ25895_BUS_MAX_BURST)
+        return HAL_ERROR;
+    *req = (BQ25895_BUS_REQUEST) {
+        .device = device,
+        .dir = dir,
+        .priority = BQ25895_Priority(reg, dir),
+        .reg = reg,
+        .data = data,
+        .len = len
+    };
+    BQ25895_BusSubmit(req);
+    return HAL_OK;
+}
+
+/**
+ * @brief Serve the bus once and check a request queued with BQ25895_DeviceSubmit().
+ * @param[in,out] *req Request.
+ * @return HAL_BUSY while the request waits, the transfer status once it was served
+ * @note Issues at most one I2C transfer and never waits for another context holding the bus.
+ * Call again while it returns HAL_BUSY, the result is reported exactly once.
+ */
+HAL_StatusTypeDef BQ25895_DevicePoll(BQ25895_BUS_REQUEST *req) {
+    if (!req->done)
+        (void) BQ25895_BusService(req->device->bus);
+    if (!req->done)
+        return HAL_BUSY;
+    if (req->status == HAL_OK)
+        BQ25895_Complete(req->device, req->dir, req->reg, req->data, req->len);
+    return req->status;
+}
+
+/**
+ * @brief BQ25895_WriteRegisters() on a given device, independent of the selection.
+ * @param[in] *device Device descriptor.
+ * @param[in] reg Address of the first register to write to.
+ * @param[in] *data Pointer to a buffer of len bytes to write from.
+ * @param[in] len Number of registers to write.
+ * @return HAL_StatusTypeDef variable describing if it was successful or not.
+ */
+HAL_StatusTypeDef BQ25895_DeviceWrite(const BQ25895_BUS_DEVICE *device, uint8_t reg, uint8_t *data, uint16_t len) {
+    HAL_StatusTypeDef status;
+    uint16_t i;
+    if (len == 0 || reg + len > BQ25895_REG_COUNT)
+        return HAL_ERROR;
+    /* Always taken in ascending order, so two bursts cannot deadlock */
+    for (i = 0; i < len; i++) {
+        if (BQ25895_LockTake(&BQ25895_reg_lock[reg + i]) != HAL_OK)
+            break;
+    }
+    status = (i == len) ? BQ25895_Transfer(device, BQ25895_BUS_WRITE, reg, data, len) : HAL_BUSY;
+    for (; i > 0; i--)
+        BQ25895_LockGive(&BQ25895_reg_lock[reg + i - 1]);
+    return status;
 }
 
 
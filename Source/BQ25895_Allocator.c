@@ -0,0 +1,216 @@
+/**
+ *  @brief     Shared input current budget allocation across several BQ25895 charge controller ICs.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Allocator.h"
+
+#define BQ25895_IINLIM_MAX_MA       (BQ25895_IINLIM_BASE + 63 * BQ25895_IINLIM_LSB)
+
+static uint8_t BQ25895_Alloc_IsCharging(const BQ25895_ALLOC_CHARGER *ch) {
+    return (ch->chrg_stat == BQ25895_PRE_CHARGE) || (ch->chrg_stat == BQ25895_FAST_CHARGE);
+}
+
+/**
+ * @brief Estimate how much input current a bay could use.
+ * @note A bay held at its limit (IDPM) asks for probe_ma more than it has, a bay collapsing its input (VDPM)
+ * keeps what it has, any other charging bay asks for its charge power converted back to input current plus
+ * headroom_ma.
+ */
+static uint16_t BQ25895_Alloc_Demand(const BQ25895_ALLOC_CONFIG *cfg, const BQ25895_ALLOC_CHARGER *ch) {
+    uint32_t demand;
+    uint16_t ceiling = (ch->max_ma < BQ25895_IINLIM_MAX_MA) ? ch->max_ma : BQ25895_IINLIM_MAX_MA;
+
+    if (ceiling < BQ25895_IINLIM_BASE)
+        ceiling = BQ25895_IINLIM_BASE;
+    if (!BQ25895_Alloc_IsCharging(ch)) {
+        demand = cfg->idle_ma;
+    } else if (ch->vdpm) {
+        demand = ch->iinlim_ma;
+    } else if (ch->idpm) {
+        demand = (uint32_t)ch->iinlim_ma + cfg->probe_ma;
+    } else {
+        demand = 0;
+        if (ch->vbus_mv != 0 && cfg->efficiency_pct != 0)
+            demand = ((uint32_t)ch->ichgr_ma * ch->vbat_mv * 100) / ((uint32_t)ch->vbus_mv * cfg->efficiency_pct);
+        demand += cfg->headroom_ma;
+    }
+    if (BQ25895_Alloc_IsCharging(ch) && demand < cfg->min_ma)
+        demand = cfg->min_ma;
+    if (demand < BQ25895_IINLIM_BASE)
+        demand = BQ25895_IINLIM_BASE;
+    return (demand < ceiling) ? demand : ceiling;
+}
+
+static uint16_t BQ25895_Alloc_Limit(const BQ25895_ALLOC_CHARGER *ch, uint8_t greedy) {
+    if (greedy && BQ25895_Alloc_IsCharging(ch) && ch->idpm && !ch->vdpm)
+        return (ch->max_ma < BQ25895_IINLIM_MAX_MA) ? ch->max_ma : BQ25895_IINLIM_MAX_MA;
+    return ch->demand_ma;
+}
+
+/**
+ * @brief Water-fill: hand out equal shares to every bay still below its limit until none is left.
+ * @note With greedy set, bays held at their input limit (IDPM) may grow up to their ceiling, so budget
+ * left over after every demand is met goes to the bays that can actually draw it.
+ */
+static uint32_t BQ25895_Alloc_Fill(BQ25895_ALLOC_CHARGER *chargers, uint8_t count, uint32_t remaining,
+        uint8_t greedy) {
+    BQ25895_ALLOC_CHARGER *ch;
+    uint32_t share;
+    uint32_t give;
+    uint16_t limit;
+    uint8_t unmet;
+    uint8_t i;
+
+    while (remaining >= BQ25895_IINLIM_LSB) {
+        unmet = 0;
+        for (i = 0; i < count; i++) {
+            if (chargers[i].max_ma != 0 && chargers[i].target_ma < BQ25895_Alloc_Limit(&chargers[i], greedy))
+                unmet++;
+        }
+        if (unmet == 0)
+            break;
+        share = remaining / unmet;
+        if (share < BQ25895_IINLIM_LSB)
+            share = BQ25895_IINLIM_LSB;
+        for (i = 0; i < count && remaining != 0; i++) {
+            ch = &chargers[i];
+            limit = BQ25895_Alloc_Limit(ch, greedy);
+            if (ch->max_ma == 0 || ch->target_ma >= limit)
+                continue;
+            give = limit - ch->target_ma;
+            if (give > share)
+                give = share;
+            if (give > remaining)
+                give = remaining;
+            ch->target_ma += give;
+            remaining -= give;
+        }
+    }
+    return remaining;
+}
+
+/**
+ * @brief Split the input current budget across the bays.
+ * @param[in] *config Budget and allocation settings.
+ * @param[in,out] *chargers Bay snapshots, target_ma is filled in.
+ * @param[in] count Number of bays.
+ * @retval HAL_ERROR if the budget cannot give every bay in use the lowest IINLIM (100mA), targets are then
+ * left at the read back IINLIM and bays have to be taken out (max_ma = 0, EN_HIZ) by the application
+ * @note Pure computation, no bus access. Every bay first gets its floor (min_ma while charging, idle_ma
+ * otherwise, the part above 100mA scaled down if the floors alone exceed the budget). The rest is
+ * water-filled: equal shares to every bay still below its demand until the demands are met or the budget is
+ * used up. What is left after that goes to the bays held at their input limit, up to their ceiling. Targets
+ * are rounded down to the IINLIM step so their sum never exceeds the budget, and increases smaller than
+ * deadband_ma are dropped so they cost no write.
+ */
+HAL_StatusTypeDef BQ25895_AllocatorRun(const BQ25895_ALLOC_CONFIG *config, BQ25895_ALLOC_CHARGER *chargers,
+        uint8_t count) {
+    BQ25895_ALLOC_CHARGER *ch;
+    uint32_t floor_sum = 0;
+    uint32_t base_sum = 0;
+    uint32_t remaining;
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        if (chargers[i].max_ma != 0)
+            base_sum += BQ25895_IINLIM_BASE;
+    }
+    if (base_sum > config->budget_ma) {
+        for (i = 0; i < count; i++)
+            chargers[i].target_ma = chargers[i].iinlim_ma;
+        return HAL_ERROR;
+    }
+
+    for (i = 0; i < count; i++) {
+        ch = &chargers[i];
+        if (ch->max_ma == 0) {
+            ch->demand_ma = 0;
+            ch->target_ma = ch->iinlim_ma;
+            continue;
+        }
+        ch->demand_ma = BQ25895_Alloc_Demand(config, ch);
+        ch->target_ma = BQ25895_Alloc_IsCharging(ch) ? config->min_ma : config->idle_ma;
+        if (ch->target_ma < BQ25895_IINLIM_BASE)
+            ch->target_ma = BQ25895_IINLIM_BASE;
+        if (ch->target_ma > ch->demand_ma)
+            ch->target_ma = ch->demand_ma;
+        floor_sum += ch->target_ma;
+    }
+
+    if (floor_sum > config->budget_ma) {
+        /* Every bay keeps the 100mA IINLIM cannot go below, only the part above it is scaled */
+        for (i = 0; i < count; i++) {
+            ch = &chargers[i];
+            if (ch->max_ma != 0)
+                ch->target_ma = BQ25895_IINLIM_BASE + ((uint32_t)(ch->target_ma - BQ25895_IINLIM_BASE)
+                        * (config->budget_ma - base_sum)) / (floor_sum - base_sum);
+        }
+        remaining = 0;
+    } else {
+        remaining = config->budget_ma - floor_sum;
+    }
+
+    remaining = BQ25895_Alloc_Fill(chargers, count, remaining, 0);
+    BQ25895_Alloc_Fill(chargers, count, remaining, 1);
+
+    for (i = 0; i < count; i++) {
+        ch = &chargers[i];
+        if (ch->max_ma == 0)
+            continue;
+        /* IINLIM_BASE is a multiple of the step, rounding down cannot go below it */
+        ch->target_ma -= (ch->target_ma - BQ25895_IINLIM_BASE) % BQ25895_IINLIM_LSB;
+        if (ch->target_ma > ch->iinlim_ma && ch->target_ma - ch->iinlim_ma < config->deadband_ma)
+            ch->target_ma = ch->iinlim_ma;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Pick the next bay whose IINLIM has to be written.
+ * @param[in] *chargers Bay snapshots after BQ25895_AllocatorRun().
+ * @param[in] count Number of bays.
+ * @retval Bay index or #BQ25895_ALLOC_NONE when every bay is up to date
+ * @note Decreases come before increases so the shared supply is never over committed in between.
+ */
+uint8_t BQ25895_AllocatorNext(const BQ25895_ALLOC_CHARGER *chargers, uint8_t count) {
+    uint8_t i;
+    for (i = 0; i < count; i++) {
+        if (chargers[i].max_ma != 0 && chargers[i].target_ma < chargers[i].iinlim_ma)
+            return i;
+    }
+    for (i = 0; i < count; i++) {
+        if (chargers[i].max_ma != 0 && chargers[i].target_ma > chargers[i].iinlim_ma)
+            return i;
+    }
+    return BQ25895_ALLOC_NONE;
+}
+
+/**
+ * @brief Write the allocated IINLIM of one bay.
+ * @param[in,out] *charger Bay snapshot, iinlim_ma is updated on success.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Writes to the BQ25895 the driver currently talks to, select the bay's device first. Whether a write
+ * is needed is decided against the IINLIM read back for the period, so a limit the chip set itself after a
+ * replug or D+/D- detection is overwritten.
+ */
+HAL_StatusTypeDef BQ25895_AllocatorApply(BQ25895_ALLOC_CHARGER *charger) {
+    HAL_StatusTypeDef status;
+    if (charger->target_ma == charger->iinlim_ma)
+        return HAL_OK;
+    status = BQ25895_SetInputCurrentLimit(&charger->target_ma);
+    if (status == HAL_OK)
+        charger->iinlim_ma = charger->target_ma;
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
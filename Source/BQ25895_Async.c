@@ -0,0 +1,170 @@
+/**
+ *  @brief     Resumable multi-step operations for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Async.h"
+
+/*
+ * Run one command step, a locked BQ25895_DeviceUpdateBits() (read and write transfer) on the device of
+ * the operation, finish on error and yield. The selected device is never touched, so operations of
+ * other threads or tasks are not affected.
+ */
+#define BQ25895_ASYNC_DO(op, call)                                                                  \
+    do {                                                                                            \
+        (op)->status = (call);                                                                      \
+        if ((op)->status != HAL_OK)                                                                 \
+            BQ25895_PT_EXIT(&(op)->pt, (op)->status);                                               \
+        BQ25895_PT_YIELD(&(op)->pt);                                                                \
+    } while (0)
+
+/*
+ * Queue a read on the device of the operation and return HAL_BUSY until the bus served it, polling
+ * the bus once per call, finish on error.
+ */
+#define BQ25895_ASYNC_READ(op, reg, data, len)                                                      \
+    do {                                                                                            \
+        (op)->status = BQ25895_DeviceSubmit(&(op)->req, (op)->device, BQ25895_BUS_READ, (reg), (data), (len)); \
+        if ((op)->status != HAL_OK)                                                                 \
+            BQ25895_PT_EXIT(&(op)->pt, (op)->status);                                               \
+        BQ25895_PT_YIELD_UNTIL(&(op)->pt, ((op)->status = BQ25895_DevicePoll(&(op)->req)) != HAL_BUSY); \
+        if ((op)->status != HAL_OK)                                                                 \
+            BQ25895_PT_EXIT(&(op)->pt, (op)->status);                                               \
+    } while (0)
+
+#define BQ25895_ASYNC_FINISH(op, result)                                                            \
+    do { (op)->status = (result); BQ25895_PT_EXIT(&(op)->pt, (op)->status); } while (0)
+
+static HAL_StatusTypeDef BQ25895_Async_SetBits(BQ25895_ASYNC *op, uint8_t reg, uint8_t mask, uint8_t value) {
+    return BQ25895_DeviceUpdateBits(op->device, reg, mask, &value);
+}
+
+static void BQ25895_Async_Start(BQ25895_ASYNC *op, uint32_t default_timeout_ms) {
+    op->start_tick = HAL_GetTick();
+    op->tick = op->start_tick;
+    op->status = HAL_OK;
+    if (op->timeout_ms == 0)
+        op->timeout_ms = default_timeout_ms;
+}
+
+static uint8_t BQ25895_Async_PollDue(BQ25895_ASYNC *op) {
+    uint32_t now = HAL_GetTick();
+    if (now - op->tick < BQ25895_ASYNC_POLL_MS)
+        return 0;
+    op->tick = now;
+    return 1;
+}
+
+static uint8_t BQ25895_Async_TimedOut(const BQ25895_ASYNC *op) {
+    return HAL_GetTick() - op->start_tick >= op->timeout_ms;
+}
+
+/**
+ * @brief Prepare an operation. Any of the BQ25895_Async* operations can then be run on it.
+ * @param[out] *op Operation instance.
+ * @param[in] *device Charger to run on, must stay valid while the operation runs.
+ * @param[in] timeout_ms Timeout or 0 for the default of the operation.
+ * @note Operations are called repeatedly from one thread and return HAL_BUSY until they finish. Each call
+ * issues at most one bus transfer for status and result reads, which are queued and polled so the
+ * operation returns HAL_BUSY instead of blocking while another context holds the bus. Command steps are
+ * one locked read-modify-write (two transfers) and block until the bus serves them. Operations on many
+ * chargers interleave without a stack per task.
+ * Do not initialise again or free an operation while it returns HAL_BUSY, its read may still be queued.
+ * Once finished, further calls return the final status until the operation is initialised again.
+ */
+void BQ25895_AsyncInit(BQ25895_ASYNC *op, const BQ25895_BUS_DEVICE *device, uint32_t timeout_ms) {
+    *op = (BQ25895_ASYNC) { 0 };
+    op->device = device;
+    op->timeout_ms = timeout_ms;
+    BQ25895_PT_INIT(&op->pt);
+}
+
+/**
+ * @brief Reset the registers to their defaults (REG_RST) and wait for the bit to clear.
+ * @param[in,out] *op Operation instance.
+ * @retval HAL_BUSY while running, HAL_OK when done, HAL_TIMEOUT or the failed transfer status otherwise
+ */
+HAL_StatusTypeDef BQ25895_AsyncReset(BQ25895_ASYNC *op) {
+    BQ25895_PT_BEGIN(&op->pt);
+    BQ25895_Async_Start(op, BQ25895_ASYNC_RESET_TIMEOUT_MS);
+    BQ25895_ASYNC_DO(op, BQ25895_Async_SetBits(op, BQ25895_REG_14, BQ25895_RESET_MASK, BQ25895_RESET_MASK));
+    do {
+        BQ25895_PT_WAIT_UNTIL(&op->pt, BQ25895_Async_PollDue(op));
+        BQ25895_ASYNC_READ(op, BQ25895_REG_14, &op->reg, 1);
+        if ((op->reg & BQ25895_RESET_MASK) && BQ25895_Async_TimedOut(op))
+            BQ25895_ASYNC_FINISH(op, HAL_TIMEOUT);
+    } while (op->reg & BQ25895_RESET_MASK);
+    BQ25895_PT_END(&op->pt, op->status);
+}
+
+/**
+ * @brief Run the input current optimizer (FORCE_ICO) and wait for ICO_OPTIMIZED.
+ * @param[in,out] *op Operation instance, value is set to the detected input current limit in mA (IDPM_LIM).
+ * @retval HAL_BUSY while running, HAL_OK when done, HAL_TIMEOUT or the failed transfer status otherwise
+ * @note ICO_EN has to be enabled.
+ */
+HAL_StatusTypeDef BQ25895_AsyncICO(BQ25895_ASYNC *op) {
+    BQ25895_PT_BEGIN(&op->pt);
+    BQ25895_Async_Start(op, BQ25895_ASYNC_ICO_TIMEOUT_MS);
+    BQ25895_ASYNC_DO(op, BQ25895_Async_SetBits(op, BQ25895_REG_09, BQ25895_FORCE_ICO_MASK, BQ25895_FORCE_ICO_MASK));
+    do {
+        BQ25895_PT_WAIT_UNTIL(&op->pt, BQ25895_Async_PollDue(op));
+        /* REG_13 (IDPM_LIM) and REG_14 (ICO_OPTIMIZED) in one burst */
+        BQ25895_ASYNC_READ(op, BQ25895_REG_13, op->data, 2);
+        op->reg = op->data[1];
+        if (!(op->reg & BQ25895_ICO_OPTIMIZED_MASK) && BQ25895_Async_TimedOut(op))
+            BQ25895_ASYNC_FINISH(op, HAL_TIMEOUT);
+    } while (!(op->reg & BQ25895_ICO_OPTIMIZED_MASK));
+    op->value = BQ25895_DECODE(op->data[0], IDPM_LIM);
+    BQ25895_PT_END(&op->pt, op->status);
+}
+
+/**
+ * @brief Start a one-shot ADC conversion (CONV_START), wait for it and read the results.
+ * @param[in,out] *op Operation instance, data holds REG_0E..REG_13 and value the battery voltage in mV.
+ * @retval HAL_BUSY while running, HAL_OK when done, HAL_TIMEOUT or the failed transfer status otherwise
+ */
+HAL_StatusTypeDef BQ25895_AsyncADCOneShot(BQ25895_ASYNC *op) {
+    BQ25895_PT_BEGIN(&op->pt);
+    BQ25895_Async_Start(op, BQ25895_ASYNC_ADC_TIMEOUT_MS);
+    BQ25895_ASYNC_DO(op, BQ25895_Async_SetBits(op, BQ25895_REG_02, BQ25895_CONV_START_MASK, BQ25895_CONV_START_MASK));
+    do {
+        BQ25895_PT_WAIT_UNTIL(&op->pt, BQ25895_Async_PollDue(op));
+        BQ25895_ASYNC_READ(op, BQ25895_REG_02, &op->reg, 1);
+        if ((op->reg & BQ25895_CONV_START_MASK) && BQ25895_Async_TimedOut(op))
+            BQ25895_ASYNC_FINISH(op, HAL_TIMEOUT);
+    } while (op->reg & BQ25895_CONV_START_MASK);
+    BQ25895_ASYNC_READ(op, BQ25895_REG_0E, op->data, BQ25895_ASYNC_ADC_LEN);
+    op->value = BQ25895_DECODE(op->data[0], BATV);
+    BQ25895_PT_END(&op->pt, op->status);
+}
+
+/**
+ * @brief Enter ship mode (BATFET_DIS), optionally after the 10s BATFET_DLY delay, and verify it was accepted.
+ * @param[in,out] *op Operation instance.
+ * @param[in] delay #BQ25895_ENABLED to turn the battery FET off after 10s, pass the same value on every call.
+ * @retval HAL_BUSY while running, HAL_OK when done, HAL_ERROR if BATFET_DIS did not stick
+ * @note Without the delay a host powered from the battery loses power before the read back.
+ */
+HAL_StatusTypeDef BQ25895_AsyncShipMode(BQ25895_ASYNC *op, BQ25895_STATE delay) {
+    BQ25895_PT_BEGIN(&op->pt);
+    BQ25895_Async_Start(op, 0);
+    BQ25895_ASYNC_DO(op, BQ25895_Async_SetBits(op, BQ25895_REG_09, BQ25895_BATFET_DLY_MASK,
+            (uint8_t) (delay << BQ25895_BATFET_DLY_BIT)));
+    BQ25895_ASYNC_DO(op, BQ25895_Async_SetBits(op, BQ25895_REG_09, BQ25895_BATFET_DIS_MASK, BQ25895_BATFET_DIS_MASK));
+    BQ25895_ASYNC_READ(op, BQ25895_REG_09, &op->reg, 1);
+    if (!(op->reg & BQ25895_BATFET_DIS_MASK))
+        BQ25895_ASYNC_FINISH(op, HAL_ERROR);
+    BQ25895_PT_END(&op->pt, op->status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,358 @@
+/**
+ *  @brief     Shared I2C bus scheduler used by the BQ25895 register I/O.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "main.h"
+#include "BQ25895_Bus.h"
+
+/**
+ * @brief Unlink a request from its priority queue. Must be called inside BQ25895_BUS_ENTER().
+ * @retval 1 if the request was queued, 0 if it was not (already collected for a transfer)
+ */
+static uint8_t BQ25895_Bus_Unlink(BQ25895_BUS *bus, BQ25895_BUS_REQUEST *req) {
+    BQ25895_BUS_REQUEST **link = &bus->head[req->priority];
+    BQ25895_BUS_REQUEST *prev = NULL;
+    while (*link != NULL && *link != req) {
+        prev = *link;
+        link = &(*link)->next;
+    }
+    if (*link == NULL)
+        return 0;
+    *link = req->next;
+    if (bus->tail[req->priority] == req)
+        bus->tail[req->priority] = prev;
+    req->next = NULL;
+    return 1;
+}
+
+/**
+ * @brief Check if a device can be reached without a channel select write.
+ */
+static uint8_t BQ25895_Bus_IsOpen(const BQ25895_BUS *bus, const BQ25895_BUS_DEVICE *device) {
+    return (device->mux == NULL) || (device->mux == bus->mux && device->mux->selected == device->channel);
+}
+
+/**
+ * @brief Pick the next request: the head of the highest non-empty class, unless a later request of that
+ * class can be served on the mux channel already open.
+ * @note Requests of one device keep their order. After #BQ25895_BUS_MAX_STICKY transfers in a row taken
+ * ahead of the class head, the head goes next so other channels are not starved.
+ */
+static BQ25895_BUS_REQUEST *BQ25895_Bus_Pick(BQ25895_BUS *bus) {
+    BQ25895_BUS_REQUEST *head = NULL;
+    BQ25895_BUS_REQUEST *req;
+    uint8_t p;
+
+    for (p = 0; p < BQ25895_BUS_PRIORITY_COUNT && head == NULL; p++)
+        head = bus->head[p];
+    if (head == NULL || BQ25895_Bus_IsOpen(bus, head->device)) {
+        bus->sticky = 0;
+        return head;
+    }
+    if (bus->sticky < BQ25895_BUS_MAX_STICKY) {
+        for (req = head->next; req != NULL; req = req->next) {
+            if (BQ25895_Bus_IsOpen(bus, req->device)) {
+                bus->sticky++;
+                return req;
+            }
+        }
+    }
+    bus->sticky = 0;
+    return head;
+}
+
+/**
+ * @brief Collect the picked request and every queued request of any class that reads (or writes) the same
+ * device in the same or an adjacent register range.
+ * @retval Number of requests in the batch, 0 if the bus is idle
+ * @note Writes are only merged when their ranges touch without overlapping, so no register is written twice.
+ */
+static uint8_t BQ25895_Bus_Collect(BQ25895_BUS *bus, BQ25895_BUS_REQUEST **batch, uint8_t *lo, uint8_t *hi) {
+    BQ25895_BUS_REQUEST *first = BQ25895_Bus_Pick(bus);
+    BQ25895_BUS_REQUEST *req;
+    BQ25895_BUS_REQUEST *next;
+    uint8_t count = 1;
+    uint8_t merged = 1;
+    uint8_t p;
+    uint8_t req_hi;
+
+    if (first == NULL)
+        return 0;
+    BQ25895_Bus_Unlink(bus, first);
+    batch[0] = first;
+    *lo = first->reg;
+    *hi = first->reg + first->len;
+
+    while (merged && count < BQ25895_BUS_MAX_BATCH) {
+        merged = 0;
+        for (p = 0; p < BQ25895_BUS_PRIORITY_COUNT && count < BQ25895_BUS_MAX_BATCH; p++) {
+            for (req = bus->head[p]; req != NULL && count < BQ25895_BUS_MAX_BATCH; req = next) {
+                next = req->next;
+                req_hi = req->reg + req->len;
+                if (req->device != first->device || req->dir != first->dir || req->len == 0)
+                    continue;
+                if (first->dir == BQ25895_BUS_WRITE ? (req_hi != *lo && req->reg != *hi)
+                        : (req_hi < *lo || req->reg > *hi))
+                    continue;
+                if ((req->reg < *lo ? req->reg : *lo) + BQ25895_BUS_MAX_BURST < (req_hi > *hi ? req_hi : *hi))
+                    continue;
+                BQ25895_Bus_Unlink(bus, req);
+                batch[count++] = req;
+                if (req->reg < *lo)
+                    *lo = req->reg;
+                if (req_hi > *hi)
+                    *hi = req_hi;
+                merged = 1;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Estimated time on the wire: address, register and data bytes of 9 bits each, plus the repeated
+ * start and address byte of a read.
+ */
+static uint32_t BQ25895_Bus_WireTime(const BQ25895_BUS *bus, BQ25895_BUS_DIR dir, uint16_t len) {
+    uint32_t bits = (2 + len) * 9 + 2;
+    if (dir == BQ25895_BUS_READ)
+        bits += 9 + 1;
+    return (bus->bus_hz != 0) ? (bits * 1000000) / bus->bus_hz : 0;
+}
+
+/**
+ * @brief Initialise a bus.
+ * @param[out] *bus Bus instance.
+ * @param[in] *i2c I2C peripheral the bus runs on.
+ * @param[in] bus_hz SCL frequency, used for the utilisation estimate.
+ */
+void BQ25895_BusInit(BQ25895_BUS *bus, I2C_HandleTypeDef *i2c, uint32_t bus_hz) {
+    *bus = (BQ25895_BUS) { 0 };
+    bus->i2c = i2c;
+    bus->bus_hz = bus_hz;
+    bus->window_tick = HAL_GetTick();
+}
+
+/**
+ * @brief Open the mux channel of a device, closing the channel of another mux on the same bus first.
+ * @param[out] *selects Incremented for every mux write issued.
+ * @note Called by the context owning the bus. A failed write leaves the selection unknown so it is redone.
+ */
+static HAL_StatusTypeDef BQ25895_Bus_Select(BQ25895_BUS *bus, const BQ25895_BUS_DEVICE *device, uint8_t *selects) {
+    HAL_StatusTypeDef status;
+    uint8_t mask = 0;
+    BQ25895_BUS_MUX *mux = device->mux;
+
+    if (BQ25895_Bus_IsOpen(bus, device))
+        return HAL_OK;
+    if (bus->mux != NULL && bus->mux != mux) {
+        /* Devices behind two muxes share an address, only one channel may be open at a time */
+        bus->mux->selected = BQ25895_BUS_MUX_NONE;
+        status = HAL_I2C_Master_Transmit(bus->i2c, bus->mux->addr, &mask, 1, BQ25895_BUS_TIMEOUT);
+        (*selects)++;
+        if (status != HAL_OK)
+            return status;
+        bus->mux = NULL;
+    }
+    mask = 1 << device->channel;
+    mux->selected = BQ25895_BUS_MUX_NONE;
+    status = HAL_I2C_Master_Transmit(bus->i2c, mux->addr, &mask, 1, BQ25895_BUS_TIMEOUT);
+    (*selects)++;
+    if (status != HAL_OK)
+        return status;
+    mux->selected = device->channel;
+    bus->mux = mux;
+    return HAL_OK;
+}
+
+/**
+ * @brief Initialise a mux. The first access through it writes its channel register.
+ * @param[out] *mux Mux instance.
+ * @param[in] addr 8 bit (shifted) I2C address of the mux.
+ */
+void BQ25895_BusMuxInit(BQ25895_BUS_MUX *mux, uint16_t addr) {
+    mux->addr = addr;
+    mux->selected = BQ25895_BUS_MUX_NONE;
+}
+
+/**
+ * @brief Queue a request on its device's bus.
+ * @param[in,out] *req Request, must stay valid until done is set.
+ * @note Requests are served by BQ25895_BusService() from any context, highest class first and in
+ * submission order within a class. Requests of different classes are not ordered against each other.
+ */
+void BQ25895_BusSubmit(BQ25895_BUS_REQUEST *req) {
+    BQ25895_BUS *bus = req->device->bus;
+    req->done = 0;
+    req->next = NULL;
+    req->submit_tick = HAL_GetTick();
+    BQ25895_BUS_ENTER();
+    if (bus->tail[req->priority] != NULL)
+        bus->tail[req->priority]->next = req;
+    else
+        bus->head[req->priority] = req;
+    bus->tail[req->priority] = req;
+    BQ25895_BUS_EXIT();
+}
+
+/**
+ * @brief Take a request back out of its queue before it is served.
+ * @param[in,out] *req Request submitted with BQ25895_BusSubmit().
+ * @retval HAL_OK if it was removed and may be reused, HAL_BUSY if it is being transferred or already done
+ */
+HAL_StatusTypeDef BQ25895_BusCancel(BQ25895_BUS_REQUEST *req) {
+    BQ25895_BUS *bus = req->device->bus;
+    uint8_t removed;
+    BQ25895_BUS_ENTER();
+    removed = !req->done && BQ25895_Bus_Unlink(bus, req);
+    BQ25895_BUS_EXIT();
+    return removed ? HAL_OK : HAL_BUSY;
+}
+
+/**
+ * @brief Serve queued requests with one I2C transfer.
+ * @param[in,out] *bus Bus instance.
+ * @retval HAL_StatusTypeDef of the transfer, HAL_OK when idle, HAL_BUSY when another context is transferring
+ * @note Blocking for the duration of one transfer. Requests merged into the batch share its status.
+ */
+HAL_StatusTypeDef BQ25895_BusService(BQ25895_BUS *bus) {
+    HAL_StatusTypeDef status;
+    BQ25895_BUS_REQUEST *batch[BQ25895_BUS_MAX_BATCH];
+    BQ25895_BUS_REQUEST *req;
+    uint8_t buffer[BQ25895_BUS_MAX_BURST];
+    uint8_t *data;
+    uint8_t count;
+    uint8_t lo;
+    uint8_t hi;
+    uint8_t i;
+    uint8_t selects = 0;
+    uint32_t now;
+
+    BQ25895_BUS_ENTER();
+    if (bus->busy) {
+        BQ25895_BUS_EXIT();
+        return HAL_BUSY;
+    }
+    count = BQ25895_Bus_Collect(bus, batch, &lo, &hi);
+    if (count == 0) {
+        BQ25895_BUS_EXIT();
+        return HAL_OK;
+    }
+    bus->busy = 1;
+    BQ25895_BUS_EXIT();
+
+    req = batch[0];
+    data = (count == 1) ? req->data : buffer;
+    status = BQ25895_Bus_Select(bus, req->device, &selects);
+    if (status != HAL_OK) {
+        /* The batch completes with the select error */
+    } else if (req->dir == BQ25895_BUS_WRITE) {
+        for (i = 0; i < count && count > 1; i++)
+            memcpy(&buffer[batch[i]->reg - lo], batch[i]->data, batch[i]->len);
+        status = HAL_I2C_Mem_Write(bus->i2c, req->device->addr, lo, I2C_MEMADD_SIZE_8BIT, data, hi - lo,
+                BQ25895_BUS_TIMEOUT);
+    } else {
+        status = HAL_I2C_Mem_Read(bus->i2c, req->device->addr, lo, I2C_MEMADD_SIZE_8BIT, data, hi - lo,
+                BQ25895_BUS_TIMEOUT);
+    }
+    now = HAL_GetTick();
+
+    BQ25895_BUS_ENTER();
+    bus->stats.mux_selects += selects;
+    bus->stats.busy_us += selects * BQ25895_Bus_WireTime(bus, BQ25895_BUS_WRITE, 0);
+    bus->stats.transactions++;
+    bus->stats.bytes += hi - lo;
+    bus->stats.busy_us += BQ25895_Bus_WireTime(bus, req->dir, hi - lo);
+    for (i = 0; i < count; i++) {
+        req = batch[i];
+        if (count > 1 && req->dir == BQ25895_BUS_READ && status == HAL_OK)
+            memcpy(req->data, &buffer[req->reg - lo], req->len);
+        if (now - req->submit_tick > bus->stats.max_wait_ms[req->priority])
+            bus->stats.max_wait_ms[req->priority] = now - req->submit_tick;
+        bus->stats.requests++;
+        req->status = status;
+        req->done = 1;
+    }
+    bus->busy = 0;
+    BQ25895_BUS_EXIT();
+    return status;
+}
+
+/**
+ * @brief Run one register transfer through the scheduler and wait for it.
+ * @param[in] *device Target device.
+ * @param[in] priority Scheduling class of the request.
+ * @param[in] dir #BQ25895_BUS_READ or #BQ25895_BUS_WRITE
+ * @param[in] reg First register.
+ * @param[in,out] *data Buffer of len bytes.
+ * @param[in] len Number of registers.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not, HAL_BUSY without a transfer
+ * if another context owns the bus and #BQ25895_BUS_CAN_WAIT is 0
+ * @note The calling context serves the queue itself until its request is done, so higher classes queued by
+ * other contexts go first and same device neighbours ride along in one transfer. On bare metal a busy bus
+ * seen here means an interrupt preempted the transfer, which cannot finish before the interrupt returns.
+ */
+HAL_StatusTypeDef BQ25895_BusTransfer(const BQ25895_BUS_DEVICE *device, BQ25895_BUS_PRIORITY priority,
+        BQ25895_BUS_DIR dir, uint8_t reg, uint8_t *data, uint16_t len) {
+    BQ25895_BUS_REQUEST req = {
+        .device = device,
+        .dir = dir,
+        .priority = priority,
+        .reg = reg,
+        .data = data,
+        .len = len
+    };
+
+    if (len > BQ25895_BUS_MAX_BURST)
+        return HAL_ERROR;
+    BQ25895_BusSubmit(&req);
+    while (!req.done) {
+        if (BQ25895_BusService(device->bus) != HAL_BUSY)
+            continue;
+#if !BQ25895_BUS_CAN_WAIT
+        if (BQ25895_BusCancel(&req) == HAL_OK)
+            return HAL_BUSY;
+#endif
+        BQ25895_BUS_YIELD();
+    }
+    return req.status;
+}
+
+/**
+ * @brief Get bus statistics for the window since the last reset.
+ * @param[in] *bus Bus instance.
+ * @param[out] *stats Statistics, utilisation in 0.1%.
+ */
+void BQ25895_BusGetStats(BQ25895_BUS *bus, BQ25895_BUS_STATS *stats) {
+    BQ25895_BUS_ENTER();
+    *stats = bus->stats;
+    BQ25895_BUS_EXIT();
+    stats->window_ms = HAL_GetTick() - bus->window_tick;
+    stats->utilisation_permille = 0;
+    if (stats->window_ms != 0)
+        stats->utilisation_permille = (stats->busy_us < stats->window_ms * 1000)
+                ? stats->busy_us / stats->window_ms : 1000;
+}
+
+/**
+ * @brief Reset the bus statistics and start a new window.
+ * @param[in,out] *bus Bus instance.
+ */
+void BQ25895_BusResetStats(BQ25895_BUS *bus) {
+    BQ25895_BUS_ENTER();
+    bus->stats = (BQ25895_BUS_STATS) { 0 };
+    bus->window_tick = HAL_GetTick();
+    BQ25895_BUS_EXIT();
+}
+
+#ifdef __cplusplus
+}
+#endif
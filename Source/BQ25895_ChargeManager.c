@@ -0,0 +1,188 @@
+/**
+ *  @brief     Non-blocking charge state machine for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_ChargeManager.h"
+
+/* REG_0B up to and including REG_14, read in one burst while waiting for ICO */
+#define BQ25895_CM_ICO_BURST_LEN    (BQ25895_REG_14 - BQ25895_REG_0B + 1)
+
+static const BQ25895_CM_CONFIG BQ25895_CM_DEFAULT_CONFIG = {
+    .poll_interval_ms = BQ25895_CM_POLL_INTERVAL_MS,
+    .detect_timeout_ms = BQ25895_CM_DETECT_TIMEOUT_MS,
+    .ico_timeout_ms = BQ25895_CM_ICO_TIMEOUT_MS,
+    .fault_holdoff_ms = BQ25895_CM_FAULT_HOLDOFF_MS,
+    .run_ico = BQ25895_ENABLED
+};
+
+static void BQ25895_CM_Enter(BQ25895_CHARGE_MANAGER *cm, BQ25895_CM_STATE state, uint32_t now) {
+    if (cm->state == state)
+        return;
+    cm->state = state;
+    cm->state_tick = now;
+}
+
+static BQ25895_CM_STATE BQ25895_CM_ChargeState(const BQ25895_CHARGE_MANAGER *cm) {
+    switch (cm->chrg_stat) {
+    case BQ25895_PRE_CHARGE:
+        return BQ25895_CM_PRE_CHARGE;
+    case BQ25895_FAST_CHARGE:
+        if (cm->state == BQ25895_CM_TERMINATED || cm->state == BQ25895_CM_RECHARGE)
+            return BQ25895_CM_RECHARGE;
+        return BQ25895_CM_FAST_CHARGE;
+    case BQ25895_CHARGE_TERMINATION:
+        return BQ25895_CM_TERMINATED;
+    default:
+        if (cm->state == BQ25895_CM_TERMINATED)
+            return BQ25895_CM_TERMINATED;
+        return BQ25895_CM_SUSPENDED;
+    }
+}
+
+static uint8_t BQ25895_CM_IsChargeFault(uint8_t fault) {
+    uint8_t ntc = BQ25895_GET_FIELD(fault, FAULT_NTC);
+    if (fault & (BQ25895_CHRG_FAULT_MASK | BQ25895_FAULT_BAT_MASK))
+        return 1;
+    return (ntc == BQ25895_BUCK_TS_COLD) || (ntc == BQ25895_BUCK_TS_HOT);
+}
+
+/**
+ * @brief Track the status and fault registers, queueing the register updates a transition needs.
+ * @retval HAL_StatusTypeDef HAL_ERROR if an update could not be queued
+ */
+static HAL_StatusTypeDef BQ25895_CM_Update(BQ25895_CHARGE_MANAGER *cm, uint8_t stat, uint8_t fault, uint32_t now) {
+    HAL_StatusTypeDef status = HAL_OK;
+    cm->vbus_stat = BQ25895_GET_FIELD(stat, VBUS_STAT);
+    cm->chrg_stat = BQ25895_GET_FIELD(stat, CHRG_STAT);
+    cm->pg_stat = BQ25895_GET_FIELD(stat, PG_STAT);
+    cm->chrg_fault = BQ25895_GET_FIELD(fault, CHRG_FAULT);
+    cm->ntc_fault = BQ25895_GET_FIELD(fault, FAULT_NTC);
+
+    if (cm->pg_stat == BQ25895_NO_POWER_GOOD) {
+        cm->updates = (BQ25895_UPDATE_QUEUE) { 0 };
+        BQ25895_CM_Enter(cm, BQ25895_CM_NO_INPUT, now);
+        return status;
+    }
+
+    if (BQ25895_CM_IsChargeFault(fault)) {
+        cm->last_fault = fault;
+        cm->clear_tick = now;
+        BQ25895_CM_Enter(cm, BQ25895_CM_FAULT, now);
+        return status;
+    }
+
+    switch (cm->state) {
+    case BQ25895_CM_NO_INPUT:
+        BQ25895_CM_Enter(cm, BQ25895_CM_INPUT_DETECT, now);
+        break;
+    case BQ25895_CM_INPUT_DETECT:
+        if (cm->vbus_stat == BQ25895_NO_INPUT && now - cm->state_tick < cm->config.detect_timeout_ms)
+            break;
+        if (cm->config.run_ico == BQ25895_ENABLED) {
+            status = BQ25895_QueueUpdate(&cm->updates, BQ25895_REG_09, BQ25895_FORCE_ICO_MASK,
+                    BQ25895_RESET << BQ25895_FORCE_ICO_BIT);
+            BQ25895_CM_Enter(cm, BQ25895_CM_ICO, now);
+        } else {
+            BQ25895_CM_Enter(cm, BQ25895_CM_ChargeState(cm), now);
+        }
+        break;
+    case BQ25895_CM_ICO:
+        if (now - cm->state_tick >= cm->config.ico_timeout_ms)
+            BQ25895_CM_Enter(cm, BQ25895_CM_ChargeState(cm), now);
+        break;
+    case BQ25895_CM_FAULT:
+        if (now - cm->clear_tick < cm->config.fault_holdoff_ms)
+            break;
+        /* A safety timer fault is only cleared by toggling CHG_CONFIG */
+        if (BQ25895_GET_FIELD(cm->last_fault, CHRG_FAULT) == BQ25895_SAFETY_TIMER) {
+            status = BQ25895_QueueUpdate(&cm->updates, BQ25895_REG_03, BQ25895_CHG_CONFIG_MASK,
+                    BQ25895_DISABLED << BQ25895_CHG_CONFIG_BIT);
+            if (status == HAL_OK)
+                status = BQ25895_QueueUpdate(&cm->updates, BQ25895_REG_03, BQ25895_CHG_CONFIG_MASK,
+                        BQ25895_ENABLED << BQ25895_CHG_CONFIG_BIT);
+        }
+        cm->last_fault = 0;
+        BQ25895_CM_Enter(cm, BQ25895_CM_ChargeState(cm), now);
+        break;
+    default:
+        BQ25895_CM_Enter(cm, BQ25895_CM_ChargeState(cm), now);
+        break;
+    }
+    return status;
+}
+
+/**
+ * @brief Initialise the charge manager.
+ * @param[out] *cm Charge manager instance.
+ * @param[in] *config Timing configuration or NULL for the defaults.
+ * @note The BQ25895 must be initialised with BQ25895_Init() before the first step.
+ */
+void BQ25895_ChargeManagerInit(BQ25895_CHARGE_MANAGER *cm, const BQ25895_CM_CONFIG *config) {
+    uint32_t now = HAL_GetTick();
+    *cm = (BQ25895_CHARGE_MANAGER) { 0 };
+    cm->config = (config != NULL) ? *config : BQ25895_CM_DEFAULT_CONFIG;
+    cm->state = BQ25895_CM_NO_INPUT;
+    cm->state_tick = now;
+    cm->poll_tick = now - cm->config.poll_interval_ms;
+}
+
+/**
+ * @brief Advance the charge manager by one step.
+ * @param[in,out] *cm Charge manager instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Every call performs at most one bus transaction (a burst read, or one register write from the
+ * register cache, see BQ25895_RunQueuedUpdate()) and never waits, so it can be called from a super-loop or a periodic RTOS task. Status is polled
+ * every poll_interval_ms; queued register updates (FORCE_ICO, fault recovery) are executed on the
+ * steps in between.
+ */
+HAL_StatusTypeDef BQ25895_ChargeManagerStep(BQ25895_CHARGE_MANAGER *cm) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_CM_ICO_BURST_LEN];
+    uint32_t now = HAL_GetTick();
+
+    if (cm->updates.count != 0)
+        return BQ25895_RunQueuedUpdate(&cm->updates);
+
+    if (now - cm->poll_tick < cm->config.poll_interval_ms)
+        return HAL_OK;
+    cm->poll_tick = now;
+
+    if (cm->state != BQ25895_CM_ICO) {
+        status = BQ25895_ReadRegisters(BQ25895_REG_0B, regs, 2);
+        if (status != HAL_OK)
+            return status;
+        return BQ25895_CM_Update(cm, regs[0], regs[1], now);
+    }
+
+    status = BQ25895_ReadRegisters(BQ25895_REG_0B, regs, BQ25895_CM_ICO_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_CM_Update(cm, regs[0], regs[1], now);
+    if (cm->state == BQ25895_CM_ICO
+            && BQ25895_GET_FIELD(regs[BQ25895_REG_14 - BQ25895_REG_0B], ICO_OPTIMIZED)) {
+        cm->ico_current_ma = BQ25895_DECODE(regs[BQ25895_REG_13 - BQ25895_REG_0B], IDPM_LIM);
+        BQ25895_CM_Enter(cm, BQ25895_CM_ChargeState(cm), now);
+    }
+    return status;
+}
+
+/**
+ * @brief Get the current charge manager state.
+ * @param[in] *cm Charge manager instance.
+ * @retval BQ25895_CM_STATE current state
+ */
+BQ25895_CM_STATE BQ25895_ChargeManagerGetState(const BQ25895_CHARGE_MANAGER *cm) {
+    return cm->state;
+}
+
+#ifdef __cplusplus
+}
+#endif
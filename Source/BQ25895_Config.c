@@ -0,0 +1,106 @@
+/**
+ *  @brief     CRC protected configuration blobs for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Config.h"
+
+/**
+ * @brief Bitwise CRC-32 (reflected, polynomial 0xEDB88320). Blobs are a few dozen bytes, no table needed.
+ */
+static uint32_t BQ25895_Config_CRC32(const uint8_t *data, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    uint8_t bit;
+    while (len--) {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Validate a configuration blob.
+ * @param[in] *blob Blob, e.g. a pointer into memory mapped flash.
+ * @param[in] size Bytes available at blob, an upper bound is enough.
+ * @retval HAL_StatusTypeDef HAL_OK if magic, version, register range and CRC are valid and no mask covers a
+ * command bit (#BQ25895_CONFIG_COMMAND_MASK), HAL_ERROR otherwise
+ */
+HAL_StatusTypeDef BQ25895_ConfigCheck(const void *blob, uint32_t size) {
+    const BQ25895_CONFIG_BLOB *cfg = (const BQ25895_CONFIG_BLOB *) blob;
+    const uint8_t *crc;
+    uint32_t len;
+    uint8_t i;
+
+    if (blob == NULL || size < BQ25895_CONFIG_HEADER_LEN)
+        return HAL_ERROR;
+    if (cfg->magic[0] != 'B' || cfg->magic[1] != 'Q' || cfg->magic[2] != 'C' || cfg->magic[3] != 'F')
+        return HAL_ERROR;
+    if (cfg->version != BQ25895_CONFIG_VERSION || cfg->count == 0
+            || cfg->first + cfg->count > BQ25895_CONFIG_LAST_REG + 1)
+        return HAL_ERROR;
+    len = BQ25895_CONFIG_SIZE(cfg->count) - BQ25895_CONFIG_CRC_LEN;
+    if (size < len + BQ25895_CONFIG_CRC_LEN)
+        return HAL_ERROR;
+    crc = (const uint8_t *) blob + len;
+    if (BQ25895_Config_CRC32((const uint8_t *) blob, len)
+            != ((uint32_t) crc[0] | ((uint32_t) crc[1] << 8) | ((uint32_t) crc[2] << 16) | ((uint32_t) crc[3] << 24)))
+        return HAL_ERROR;
+    /* A CRC valid blob can still start ICO, reset the chip or cut the battery on every apply */
+    for (i = 0; i < cfg->count; i++)
+        if (cfg->data[i] & BQ25895_CONFIG_COMMAND_MASK(cfg->first + i))
+            return HAL_ERROR;
+    return HAL_OK;
+}
+
+/**
+ * @brief Validate a configuration blob and write it to the selected BQ25895.
+ * @param[in] *blob Blob, e.g. a pointer into memory mapped flash.
+ * @param[in] size Bytes available at blob, an upper bound is enough.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Register values are written straight from the blob. Runs of whole register masks go out as one
+ * burst, partial masks as BQ25895_UpdateBits(), zero masks are skipped. Nothing is written if the blob is
+ * invalid.
+ */
+HAL_StatusTypeDef BQ25895_ConfigApply(const void *blob, uint32_t size) {
+    const BQ25895_CONFIG_BLOB *cfg = (const BQ25895_CONFIG_BLOB *) blob;
+    const uint8_t *mask;
+    const uint8_t *value;
+    HAL_StatusTypeDef status;
+    uint8_t i = 0;
+    uint8_t run;
+
+    status = BQ25895_ConfigCheck(blob, size);
+    if (status != HAL_OK)
+        return status;
+    mask = cfg->data;
+    value = cfg->data + cfg->count;
+
+    while (i < cfg->count) {
+        if (mask[i] == 0xFF) {
+            for (run = 1; i + run < cfg->count && mask[i + run] == 0xFF; run++)
+                ;
+            /* The driver only reads from data, the cast does not write to flash */
+            status = BQ25895_WriteRegisters(cfg->first + i, (uint8_t *) &value[i], run);
+            i += run;
+        } else {
+            if (mask[i] != 0)
+                status = BQ25895_UpdateBits(cfg->first + i, mask[i], (uint8_t *) &value[i]);
+            i++;
+        }
+        if (status != HAL_OK)
+            return status;
+    }
+    return HAL_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
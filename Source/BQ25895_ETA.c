@@ -0,0 +1,154 @@
+/**
+ *  @brief     Streaming charge time-to-full estimator for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_ETA.h"
+
+/* REG_04 (ICHG), REG_05 (ITERM) and REG_06 (VREG) in one burst */
+#define BQ25895_ETA_BURST_LEN       (BQ25895_REG_06 - BQ25895_REG_04 + 1)
+
+/**
+ * @brief log2(value) in Q8, with the fractional part linearly interpolated (max error 0.09).
+ */
+static uint32_t BQ25895_ETA_Log2Q8(uint32_t value) {
+    uint32_t exponent = 0;
+    if (value == 0)
+        return 0;
+    while ((value >> exponent) > 1)
+        exponent++;
+    return (exponent << 8) + (((value << 8) >> exponent) - 256);
+}
+
+/**
+ * @brief Time for the CV current to decay from current_ma to ITERM: tau x ln(current / ITERM).
+ */
+static uint32_t BQ25895_ETA_CVTime(const BQ25895_ETA *eta, uint16_t current_ma) {
+    uint32_t ln_q8;
+    if (current_ma <= eta->iterm_ma || eta->iterm_ma == 0)
+        return 0;
+    /* ln(x) = log2(x) x 0.6931, 0.6931 ~ 177 / 256 */
+    ln_q8 = ((BQ25895_ETA_Log2Q8(current_ma) - BQ25895_ETA_Log2Q8(eta->iterm_ma)) * 177) >> 8;
+    return ((uint32_t)eta->cv_tau_s * ln_q8) >> 8;
+}
+
+static void BQ25895_ETA_Anchor(BQ25895_ETA *eta, BQ25895_ETA_PHASE phase, uint16_t current_ma, uint16_t voltage_mv,
+        uint32_t now_ms) {
+    eta->phase = phase;
+    eta->anchor_mv = voltage_mv;
+    eta->anchor_ma = current_ma;
+    eta->anchor_ms = now_ms;
+}
+
+/**
+ * @brief Initialise the estimator with the default CV time constant.
+ * @param[out] *eta Estimator instance.
+ * @note Call once, then BQ25895_ETALoad() before the first sample.
+ */
+void BQ25895_ETAInit(BQ25895_ETA *eta) {
+    *eta = (BQ25895_ETA) { 0 };
+    eta->cv_tau_s = BQ25895_ETA_CV_TAU_S;
+    eta->eta_s = BQ25895_ETA_UNKNOWN;
+}
+
+/**
+ * @brief Load the charge setpoints the model is based on.
+ * @param[in,out] *eta Estimator initialised with BQ25895_ETAInit().
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note One burst read of REG_04 - REG_06, decoded with BQ25895_DECODE() like BQ25895_GetFastChargeCurrent(),
+ * BQ25895_GetTermChargeCurrent() and BQ25895_GetChargeVoltage(). Call again when the setpoints change; the
+ * model restarts from the next sample but the learned CV time constant is kept.
+ */
+HAL_StatusTypeDef BQ25895_ETALoad(BQ25895_ETA *eta) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_ETA_BURST_LEN];
+    uint16_t cv_tau_s = eta->cv_tau_s;
+
+    BQ25895_ETAInit(eta);
+    if (cv_tau_s != 0)
+        eta->cv_tau_s = cv_tau_s;
+    status = BQ25895_ReadRegisters(BQ25895_REG_04, regs, BQ25895_ETA_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    eta->ichg_ma = BQ25895_DECODE(regs[BQ25895_REG_04 - BQ25895_REG_04], ICHG);
+    eta->iterm_ma = BQ25895_DECODE(regs[BQ25895_REG_05 - BQ25895_REG_04], ITERM);
+    eta->vreg_mv = BQ25895_DECODE(regs[BQ25895_REG_06 - BQ25895_REG_04], VREG);
+    return status;
+}
+
+/**
+ * @brief Feed one ICHGR/BATV sample into the estimator.
+ * @param[in,out] *eta Estimator instance.
+ * @param[in] current_ma Charge current in mA (ICHGR)
+ * @param[in] voltage_mv Battery voltage in mV (BATV)
+ * @param[in] now_ms Sample time in ms, e.g. HAL_GetTick()
+ * @note O(1), no bus access. In CC the BATV slope is measured against an anchor sample once BATV rose by
+ * BQ25895_ETA_MIN_RISE_MV, giving the time to reach VREG, and CV is expected to start at ICHG. CV is entered
+ * only when BATV is within BQ25895_ETA_CV_MARGIN_MV of VREG, a current drop below ICHG alone is thermal or
+ * input limiting. In CV the current is modelled as an exponential decay towards ITERM; its time constant is
+ * learned once the current fell by BQ25895_ETA_MIN_DECAY_PCT.
+ */
+void BQ25895_ETAUpdate(BQ25895_ETA *eta, uint16_t current_ma, uint16_t voltage_mv, uint32_t now_ms) {
+    uint32_t dt_s = (now_ms - eta->anchor_ms) / 1000;
+    uint32_t cc_s;
+    uint32_t ln_q8;
+
+    if (!eta->valid) {
+        BQ25895_ETA_Anchor(eta, BQ25895_ETA_CC, current_ma, voltage_mv, now_ms);
+        eta->valid = 1;
+    }
+
+    if (current_ma <= eta->iterm_ma) {
+        eta->phase = BQ25895_ETA_DONE;
+        eta->eta_s = 0;
+        return;
+    }
+    if (eta->phase == BQ25895_ETA_CC && voltage_mv + BQ25895_ETA_CV_MARGIN_MV >= eta->vreg_mv)
+        BQ25895_ETA_Anchor(eta, BQ25895_ETA_CV, current_ma, voltage_mv, now_ms);
+    else if (eta->phase == BQ25895_ETA_DONE)
+        BQ25895_ETA_Anchor(eta, BQ25895_ETA_CC, current_ma, voltage_mv, now_ms);
+
+    if (eta->phase == BQ25895_ETA_CV) {
+        if (current_ma * 100 <= eta->anchor_ma * (100 - BQ25895_ETA_MIN_DECAY_PCT) && dt_s > 0) {
+            ln_q8 = ((BQ25895_ETA_Log2Q8(eta->anchor_ma) - BQ25895_ETA_Log2Q8(current_ma)) * 177) >> 8;
+            if (ln_q8 > 0)
+                eta->cv_tau_s = ((dt_s << 8) / ln_q8 > 0xFFFF) ? 0xFFFF : (dt_s << 8) / ln_q8;
+            BQ25895_ETA_Anchor(eta, BQ25895_ETA_CV, current_ma, voltage_mv, now_ms);
+        }
+        eta->eta_s = BQ25895_ETA_CVTime(eta, current_ma);
+        return;
+    }
+
+    if (voltage_mv >= eta->anchor_mv + BQ25895_ETA_MIN_RISE_MV && dt_s > 0) {
+        eta->rise_uv_per_s = ((uint32_t)(voltage_mv - eta->anchor_mv) * 1000) / dt_s;
+        BQ25895_ETA_Anchor(eta, BQ25895_ETA_CC, current_ma, voltage_mv, now_ms);
+    }
+    if (eta->rise_uv_per_s == 0) {
+        eta->eta_s = BQ25895_ETA_UNKNOWN;
+        return;
+    }
+    cc_s = ((uint32_t)(eta->vreg_mv - BQ25895_ETA_CV_MARGIN_MV - voltage_mv) * 1000) / eta->rise_uv_per_s;
+    /* The CC current reference is ICHG, a momentarily throttled current does not shorten the CV phase */
+    eta->eta_s = cc_s + BQ25895_ETA_CVTime(eta, (eta->ichg_ma > current_ma) ? eta->ichg_ma : current_ma);
+}
+
+/**
+ * @brief Get the estimated time to full.
+ * @param[in] *eta Estimator instance.
+ * @retval Remaining charge time in seconds, #BQ25895_ETA_UNKNOWN while still learning the CC slope
+ * @note O(1), returns the value computed by the last BQ25895_ETAUpdate().
+ */
+uint32_t BQ25895_ETAGet(const BQ25895_ETA *eta) {
+    return eta->eta_s;
+}
+
+#ifdef __cplusplus
+}
+#endif
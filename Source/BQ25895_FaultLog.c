@@ -0,0 +1,305 @@
+/**
+ *  @brief     Per device fault history with batched persistence for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include "main.h"
+#include "BQ25895_FaultLog.h"
+
+_Static_assert((BQ25895_FAULT_LOG_LEN & (BQ25895_FAULT_LOG_LEN - 1)) == 0, "FAULT_LOG_LEN must be a power of two");
+_Static_assert(BQ25895_FAULT_BATCH <= BQ25895_FAULT_LOG_LEN, "FAULT_BATCH larger than the ring");
+
+/* Flash record: sequence number, event, inverted sequence number. Erased (all 0xFF) records never check out */
+typedef struct BQ25895_FAULT_RECORD {
+    uint32_t seq;
+    BQ25895_FAULT_EVENT event;
+    uint32_t check;
+} BQ25895_FAULT_RECORD;
+
+_Static_assert(sizeof(BQ25895_FAULT_RECORD) == BQ25895_FAULT_RECORD_LEN, "flash record layout");
+
+static BQ25895_FAULT_LOG *BQ25895_fault_logs[BQ25895_FAULT_LOG_MAX];
+
+/**
+ * @brief BQ25895_FAULT_HOOK feeding the history of the device that was read.
+ * @note The registry is scanned under the lock, the append takes it again on its own.
+ */
+static void BQ25895_FaultLog_Hook(const BQ25895_BUS_DEVICE *device, uint8_t fault) {
+    BQ25895_FAULT_LOG *log = NULL;
+    uint8_t i;
+
+    BQ25895_LockEnter();
+    for (i = 0; i < BQ25895_FAULT_LOG_MAX && BQ25895_fault_logs[i] != NULL; i++) {
+        if (BQ25895_fault_logs[i]->device == device) {
+            log = BQ25895_fault_logs[i];
+            break;
+        }
+    }
+    BQ25895_LockExit();
+    if (log != NULL)
+        BQ25895_FaultLogAppend(log, fault, HAL_GetTick());
+}
+
+/**
+ * @brief Attach a fault history to a device. Every later read of REG_0C on the device feeds it.
+ * @param[out] *log History to initialise, must stay valid while the device is in use.
+ * @param[in] *device Device whose fault register is tracked.
+ * @param[in] id Stored in every event so several devices can share one backend.
+ * @param[in] *backend Persistence backend, NULL to keep the history in RAM only.
+ * @retval HAL_StatusTypeDef HAL_ERROR if BQ25895_FAULT_LOG_MAX devices are already tracked
+ * @note Installs the fault hook of BQ25895_SetFaultHook(), BQ25895_FaultCallback() is left to the application.
+ */
+HAL_StatusTypeDef BQ25895_FaultLogInit(BQ25895_FAULT_LOG *log, const BQ25895_BUS_DEVICE *device, uint8_t id,
+        const BQ25895_FAULT_BACKEND *backend) {
+    HAL_StatusTypeDef status = HAL_ERROR;
+    uint8_t i;
+
+    memset(log, 0, sizeof(*log));
+    log->device = device;
+    log->backend = backend;
+    log->id = id;
+
+    BQ25895_LockEnter();
+    for (i = 0; i < BQ25895_FAULT_LOG_MAX; i++) {
+        if (BQ25895_fault_logs[i] == NULL || BQ25895_fault_logs[i] == log
+                || BQ25895_fault_logs[i]->device == device) {
+            BQ25895_fault_logs[i] = log;
+            status = HAL_OK;
+            break;
+        }
+    }
+    BQ25895_LockExit();
+    if (status == HAL_OK)
+        BQ25895_SetFaultHook(BQ25895_FaultLog_Hook);
+    return status;
+}
+
+/**
+ * @brief Record a REG_0C value if it differs from the previous one, including the return to 0.
+ * @param[in] *log History to append to.
+ * @param[in] fault REG_0C contents.
+ * @param[in] tick Time of the read.
+ * @note O(1) and never touches the backend, safe from the read path. The oldest event is overwritten when
+ * the ring is full.
+ */
+void BQ25895_FaultLogAppend(BQ25895_FAULT_LOG *log, uint8_t fault, uint32_t tick) {
+    BQ25895_FAULT_EVENT *event;
+
+    BQ25895_LockEnter();
+    if (fault != log->last_fault) {
+        log->last_fault = fault;
+        event = &log->events[log->total & (BQ25895_FAULT_LOG_LEN - 1)];
+        event->tick = tick;
+        event->device = log->id;
+        event->fault = fault;
+        event->reserved[0] = 0;
+        event->reserved[1] = 0;
+        log->total++;
+    }
+    BQ25895_LockExit();
+}
+
+/**
+ * @brief Read back an event from RAM.
+ * @param[in] *log History to read.
+ * @param[in] age 0 for the newest event, 1 for the one before, ...
+ * @param[out] *event Copy of the event.
+ * @retval HAL_StatusTypeDef HAL_ERROR if the ring does not hold that many events
+ */
+HAL_StatusTypeDef BQ25895_FaultLogGet(const BQ25895_FAULT_LOG *log, uint16_t age, BQ25895_FAULT_EVENT *event) {
+    HAL_StatusTypeDef status = HAL_ERROR;
+
+    BQ25895_LockEnter();
+    if (age < BQ25895_FAULT_LOG_LEN && age < log->total) {
+        *event = log->events[(log->total - 1 - age) & (BQ25895_FAULT_LOG_LEN - 1)];
+        status = HAL_OK;
+    }
+    BQ25895_LockExit();
+    return status;
+}
+
+/**
+ * @brief Hand pending events to the backend. Call from the main loop or a low priority task.
+ * @param[in] *log History to flush.
+ * @param[in] force Non-zero to flush everything now, e.g. before entering ship mode.
+ * @retval HAL_StatusTypeDef status of the backend, HAL_OK if nothing was due
+ * @note Without force a batch is written once BQ25895_FAULT_BATCH events are pending or the oldest pending
+ * event is BQ25895_FAULT_FLUSH_MS old. Events are copied out under the lock and the backend runs outside
+ * it, so reads of REG_0C never wait for flash.
+ */
+HAL_StatusTypeDef BQ25895_FaultLogService(BQ25895_FAULT_LOG *log, uint8_t force) {
+    BQ25895_FAULT_EVENT batch[BQ25895_FAULT_BATCH];
+    HAL_StatusTypeDef status;
+    uint32_t first;
+    uint16_t count;
+    uint16_t i;
+
+    if (log->backend == NULL || log->backend->write == NULL)
+        return HAL_OK;
+
+    do {
+        BQ25895_LockEnter();
+        if (log->total - log->saved > BQ25895_FAULT_LOG_LEN) {
+            log->lost += log->total - log->saved - BQ25895_FAULT_LOG_LEN;
+            log->saved = log->total - BQ25895_FAULT_LOG_LEN;
+        }
+        first = log->saved;
+        count = (uint16_t) (log->total - first);
+        if (count > BQ25895_FAULT_BATCH)
+            count = BQ25895_FAULT_BATCH;
+        if (!force && count < BQ25895_FAULT_BATCH && (count == 0
+                || HAL_GetTick() - log->events[first & (BQ25895_FAULT_LOG_LEN - 1)].tick < BQ25895_FAULT_FLUSH_MS))
+            count = 0;
+        for (i = 0; i < count; i++)
+            batch[i] = log->events[(first + i) & (BQ25895_FAULT_LOG_LEN - 1)];
+        BQ25895_LockExit();
+
+        if (count == 0)
+            return HAL_OK;
+        status = log->backend->write(log->backend->context, batch, count);
+        if (status != HAL_OK)
+            return status;
+
+        BQ25895_LockEnter();
+        /* Only move forward, the ring may have overrun and been resynchronised meanwhile */
+        if ((int32_t) (first + count - log->saved) > 0)
+            log->saved = first + count;
+        BQ25895_LockExit();
+    } while (force);
+    return HAL_OK;
+}
+
+/*------------------------------------ FLASH BACKEND --------------------------------------------*/
+static uint32_t BQ25895_Flash_Size(const BQ25895_FAULT_FLASH *flash) {
+    return flash->page_size * flash->pages;
+}
+
+static const BQ25895_FAULT_RECORD *BQ25895_Flash_Record(const BQ25895_FAULT_FLASH *flash, uint32_t offset) {
+    return (const BQ25895_FAULT_RECORD *) (flash->base + offset);
+}
+
+static uint8_t BQ25895_Flash_Valid(const BQ25895_FAULT_RECORD *record) {
+    return record->check == ~record->seq;
+}
+
+static uint8_t BQ25895_Flash_Blank(const BQ25895_FAULT_RECORD *record) {
+    const uint8_t *byte = (const uint8_t *) record;
+    uint8_t i;
+    for (i = 0; i < BQ25895_FAULT_RECORD_LEN; i++) {
+        if (byte[i] != 0xFF)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Find the newest record after a reset. Must be called before the backend is used.
+ * @param[in,out] *flash Backend with base, page_size, pages, erase and program filled in.
+ * @retval HAL_StatusTypeDef HAL_ERROR if the geometry is unusable
+ * @note Writing resumes at the first blank record after the newest one. A record torn by a power loss is
+ * skipped, the rest of its page is used and the next page is erased when it is reached.
+ */
+HAL_StatusTypeDef BQ25895_FaultFlashMount(BQ25895_FAULT_FLASH *flash) {
+    const BQ25895_FAULT_RECORD *record;
+    uint32_t size = BQ25895_Flash_Size(flash);
+    uint32_t newest = 0;
+    uint32_t offset;
+    uint8_t found = 0;
+
+    if (flash->pages < 2 || flash->page_size < BQ25895_FAULT_RECORD_LEN
+            || flash->page_size % BQ25895_FAULT_RECORD_LEN != 0 || flash->erase == NULL || flash->program == NULL)
+        return HAL_ERROR;
+
+    flash->seq = 0;
+    for (offset = 0; offset < size; offset += BQ25895_FAULT_RECORD_LEN) {
+        record = BQ25895_Flash_Record(flash, offset);
+        if (BQ25895_Flash_Valid(record) && (!found || (int32_t) (record->seq - flash->seq) > 0)) {
+            flash->seq = record->seq;
+            newest = offset;
+            found = 1;
+        }
+    }
+    if (!found) {
+        /* Nothing stored yet, page 0 is erased before the first write */
+        flash->offset = 0;
+        return HAL_OK;
+    }
+
+    offset = newest + BQ25895_FAULT_RECORD_LEN;
+    while (offset % flash->page_size != 0 && !BQ25895_Flash_Blank(BQ25895_Flash_Record(flash, offset)))
+        offset += BQ25895_FAULT_RECORD_LEN;
+    flash->offset = offset % size;
+    return HAL_OK;
+}
+
+/**
+ * @brief BQ25895_FAULT_BACKEND write function, context is a mounted BQ25895_FAULT_FLASH.
+ * @note Pages are used round robin, so every page sees one erase per pass over the whole area. The page
+ * ahead is erased only when the first record of it is written.
+ */
+HAL_StatusTypeDef BQ25895_FaultFlashWrite(void *context, const BQ25895_FAULT_EVENT *events, uint16_t count) {
+    BQ25895_FAULT_FLASH *flash = (BQ25895_FAULT_FLASH *) context;
+    BQ25895_FAULT_RECORD record;
+    HAL_StatusTypeDef status;
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        if (flash->offset % flash->page_size == 0) {
+            status = flash->erase(flash->base + flash->offset);
+            if (status != HAL_OK)
+                return status;
+        }
+        record.seq = flash->seq + 1;
+        record.event = events[i];
+        record.check = ~record.seq;
+        status = flash->program(flash->base + flash->offset, (const uint8_t *) &record, sizeof(record));
+        if (status != HAL_OK)
+            return status;
+        flash->seq = record.seq;
+        flash->offset = (flash->offset + BQ25895_FAULT_RECORD_LEN) % BQ25895_Flash_Size(flash);
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Read back a stored event, e.g. to report the history after a reset.
+ * @param[in] *flash Mounted backend.
+ * @param[in] age 0 for the newest record, 1 for the one before, ...
+ * @param[out] *event Copy of the event.
+ * @retval HAL_StatusTypeDef HAL_ERROR once the records run out or were erased
+ */
+HAL_StatusTypeDef BQ25895_FaultFlashRead(const BQ25895_FAULT_FLASH *flash, uint32_t age, BQ25895_FAULT_EVENT *event) {
+    const BQ25895_FAULT_RECORD *record;
+    uint32_t size = BQ25895_Flash_Size(flash);
+    uint32_t offset = flash->offset;
+    uint32_t seq = flash->seq;
+    uint32_t i;
+
+    if (age >= seq || age >= size / BQ25895_FAULT_RECORD_LEN)
+        return HAL_ERROR;
+    /* Walk back over valid records, skipping the ones torn by a power loss */
+    for (i = 0; i < size / BQ25895_FAULT_RECORD_LEN; i++) {
+        offset = (offset + size - BQ25895_FAULT_RECORD_LEN) % size;
+        record = BQ25895_Flash_Record(flash, offset);
+        if (!BQ25895_Flash_Valid(record) || record->seq != seq)
+            continue;
+        if (seq == flash->seq - age) {
+            *event = record->event;
+            return HAL_OK;
+        }
+        seq--;
+    }
+    return HAL_ERROR;
+}
+
+#ifdef __cplusplus
+}
+#endif
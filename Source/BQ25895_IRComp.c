@@ -0,0 +1,139 @@
+/**
+ *  @brief     Battery resistance estimation and IR compensation tuning for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_IRComp.h"
+
+#define BQ25895_BAT_COMP_MAX_MOHM   (BQ25895_BAT_COMP_BASE + 7 * BQ25895_BAT_COMP_LSB)
+#define BQ25895_VCLAMP_MAX_MV       (BQ25895_VCLAMP_BASE + 7 * BQ25895_VCLAMP_LSB)
+
+static const BQ25895_IRCOMP_CONFIG BQ25895_IRCOMP_DEFAULT_CONFIG = {
+    .min_step_ma = BQ25895_IRCOMP_MIN_STEP_MA,
+    .max_pair_ms = BQ25895_IRCOMP_MAX_PAIR_MS,
+    .weight_q8 = BQ25895_IRCOMP_WEIGHT_Q8,
+    .comp_fraction_q8 = BQ25895_IRCOMP_FRACTION_Q8,
+    .max_comp_mohm = BQ25895_IRCOMP_MAX_COMP_MOHM,
+    .max_clamp_mv = BQ25895_IRCOMP_MAX_CLAMP_MV,
+    .min_samples = BQ25895_IRCOMP_MIN_SAMPLES
+};
+
+/**
+ * @brief Initialise the resistance estimator.
+ * @param[out] *ir Estimator instance.
+ * @param[in] *config Estimator configuration or NULL for the defaults.
+ * @note The BAT_COMP and VCLAMP limits are capped to the register ranges.
+ */
+void BQ25895_IRCompInit(BQ25895_IRCOMP *ir, const BQ25895_IRCOMP_CONFIG *config) {
+    *ir = (BQ25895_IRCOMP) { 0 };
+    ir->config = (config != NULL) ? *config : BQ25895_IRCOMP_DEFAULT_CONFIG;
+    if (ir->config.max_comp_mohm > BQ25895_BAT_COMP_MAX_MOHM)
+        ir->config.max_comp_mohm = BQ25895_BAT_COMP_MAX_MOHM;
+    if (ir->config.max_clamp_mv > BQ25895_VCLAMP_MAX_MV)
+        ir->config.max_clamp_mv = BQ25895_VCLAMP_MAX_MV;
+}
+
+/**
+ * @brief Feed one BATV/ICHGR sample pair into the estimator.
+ * @param[in,out] *ir Estimator instance.
+ * @param[in] current_ma Charge current in mA (ICHGR)
+ * @param[in] voltage_mv Battery voltage in mV (BATV)
+ * @param[in] now_ms Sample time in ms, e.g. HAL_GetTick()
+ * @note When the current stepped by at least min_step_ma since the previous sample (ICHG change, JEITA or
+ * thermal derating, input limit change) and the samples are at most max_pair_ms apart, dV/dI is taken as a
+ * resistance sample. Samples whose voltage moved against the current are discarded.
+ */
+void BQ25895_IRCompAddSample(BQ25895_IRCOMP *ir, uint16_t current_ma, uint16_t voltage_mv, uint32_t now_ms) {
+    int32_t di = (int32_t)current_ma - ir->last_ma;
+    int32_t dv = (int32_t)voltage_mv - ir->last_mv;
+    uint32_t r_mohm;
+
+    if (current_ma > ir->peak_ma)
+        ir->peak_ma = current_ma;
+
+    if (ir->has_last && now_ms - ir->last_ms <= ir->config.max_pair_ms
+            && (di >= ir->config.min_step_ma || -di >= ir->config.min_step_ma)) {
+        if (di < 0) {
+            di = -di;
+            dv = -dv;
+        }
+        if (dv >= 0) {
+            r_mohm = ((uint32_t)dv * 1000) / (uint32_t)di;
+            if (r_mohm <= BQ25895_IRCOMP_MAX_MOHM) {
+                if (ir->samples == 0)
+                    ir->r_mohm_q8 = r_mohm << 8;
+                else
+                    ir->r_mohm_q8 = ir->r_mohm_q8 + (((int32_t)(r_mohm << 8) - (int32_t)ir->r_mohm_q8)
+                            * (int32_t)ir->config.weight_q8) / 256;
+                if (ir->samples < 0xFF)
+                    ir->samples++;
+            }
+        }
+    }
+
+    ir->last_ma = current_ma;
+    ir->last_mv = voltage_mv;
+    ir->last_ms = now_ms;
+    ir->has_last = 1;
+}
+
+/**
+ * @brief Get the estimated pack plus trace resistance.
+ * @param[in] *ir Estimator instance.
+ * @retval Resistance in mOhm, 0 while no sample has been taken
+ */
+uint16_t BQ25895_IRCompGetResistance(const BQ25895_IRCOMP *ir) {
+    return ir->r_mohm_q8 >> 8;
+}
+
+/**
+ * @brief Program BAT_COMP and VCLAMP from the resistance estimate.
+ * @param[in,out] *ir Estimator instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note BAT_COMP = comp_fraction_q8 x R, rounded down to 20mOhm and capped at max_comp_mohm.
+ * VCLAMP = BAT_COMP x highest charge current seen, rounded up to 32mV and capped at max_clamp_mv.
+ * REG_08 is only touched when at least min_samples were taken and the result differs from the last write.
+ * The first write is always made, REG_08 may hold values from before BQ25895_IRCompInit().
+ */
+HAL_StatusTypeDef BQ25895_IRCompTune(BQ25895_IRCOMP *ir) {
+    HAL_StatusTypeDef status;
+    uint32_t comp_mohm;
+    uint32_t clamp_mv;
+    uint8_t temp;
+
+    if (ir->samples < ir->config.min_samples)
+        return HAL_OK;
+
+    comp_mohm = (ir->r_mohm_q8 * ir->config.comp_fraction_q8) >> 16;
+    if (comp_mohm > ir->config.max_comp_mohm)
+        comp_mohm = ir->config.max_comp_mohm;
+    comp_mohm -= comp_mohm % BQ25895_BAT_COMP_LSB;
+
+    clamp_mv = (comp_mohm * ir->peak_ma + 999) / 1000;
+    clamp_mv = ((clamp_mv + BQ25895_VCLAMP_LSB - 1) / BQ25895_VCLAMP_LSB) * BQ25895_VCLAMP_LSB;
+    if (clamp_mv > ir->config.max_clamp_mv)
+        clamp_mv = ir->config.max_clamp_mv - ir->config.max_clamp_mv % BQ25895_VCLAMP_LSB;
+
+    if (ir->written && comp_mohm == ir->comp_mohm && clamp_mv == ir->clamp_mv)
+        return HAL_OK;
+
+    temp = BQ25895_ENCODE(comp_mohm, BAT_COMP) | BQ25895_ENCODE(clamp_mv, VCLAMP);
+    status = BQ25895_UpdateBits(BQ25895_REG_08, BQ25895_BAT_COMP_MASK | BQ25895_VCLAMP_MASK, &temp);
+    if (status != HAL_OK)
+        return status;
+    ir->written = 1;
+    ir->comp_mohm = comp_mohm;
+    ir->clamp_mv = clamp_mv;
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
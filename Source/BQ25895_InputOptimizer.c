@@ -0,0 +1,191 @@
+/**
+ *  @brief     Closed-loop input power optimizer for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_InputOptimizer.h"
+
+#define BQ25895_IO_PENDING_IINLIM   0x01
+#define BQ25895_IO_PENDING_VINDPM   0x02
+
+/* REG_11 (VBUSV), REG_12 (ICHGR) and REG_13 (VDPM/IDPM status) are read in one burst */
+#define BQ25895_IO_BURST_LEN        (BQ25895_REG_13 - BQ25895_REG_11 + 1)
+
+static const BQ25895_IO_CONFIG BQ25895_IO_DEFAULT_CONFIG = {
+    .iinlim_min_ma = BQ25895_IO_IINLIM_MIN_MA,
+    .iinlim_max_ma = BQ25895_IO_IINLIM_MAX_MA,
+    .iinlim_step_ma = BQ25895_IO_IINLIM_STEP_MA,
+    .vindpm_min_mv = BQ25895_IO_VINDPM_MIN_MV,
+    .vindpm_max_mv = BQ25895_IO_VINDPM_MAX_MV,
+    .vindpm_headroom_mv = BQ25895_IO_VINDPM_HEADROOM_MV,
+    .period_ms = BQ25895_IO_PERIOD_MS,
+    .probe_interval_ms = BQ25895_IO_PROBE_INTERVAL_MS
+};
+
+static void BQ25895_IO_SetInputCurrent(BQ25895_INPUT_OPTIMIZER *opt, uint16_t current_ma) {
+    if (current_ma == opt->iinlim_ma)
+        return;
+    opt->iinlim_ma = current_ma;
+    opt->pending |= BQ25895_IO_PENDING_IINLIM;
+}
+
+static void BQ25895_IO_SetVINDPM(BQ25895_INPUT_OPTIMIZER *opt, uint16_t voltage_mv) {
+    voltage_mv -= voltage_mv % BQ25895_VINDPM_LSB;
+    if (voltage_mv == opt->vindpm_mv)
+        return;
+    opt->vindpm_mv = voltage_mv;
+    opt->pending |= BQ25895_IO_PENDING_VINDPM;
+}
+
+/**
+ * @brief One control iteration, hill climbing IINLIM on the measured charge current.
+ * @note IINLIM is raised while the input is current limited (IDPM) and VBUS still has headroom,
+ * kept only if the charge current actually increased, and lowered as soon as the adapter starts
+ * to collapse (VDPM). The highest working value is remembered as a ceiling that is re-probed
+ * every probe_interval_ms in case the source improved.
+ */
+static void BQ25895_IO_Control(BQ25895_INPUT_OPTIMIZER *opt, uint32_t now) {
+    const BQ25895_IO_CONFIG *cfg = &opt->config;
+    uint16_t limit = (opt->ceiling_ma < cfg->iinlim_max_ma) ? opt->ceiling_ma : cfg->iinlim_max_ma;
+    uint32_t vindpm;
+
+    if (now - opt->probe_tick >= cfg->probe_interval_ms) {
+        opt->ceiling_ma = cfg->iinlim_max_ma;
+        opt->probe_tick = now;
+    }
+
+    if (opt->probing) {
+        opt->probing = 0;
+        if (opt->ichg_ma <= opt->probe_ichg_ma && opt->vdpm_stat == BQ25895_DISABLED) {
+            /* More input current did not buy more charge current, stay below the probed value */
+            opt->ceiling_ma = opt->iinlim_ma - cfg->iinlim_step_ma;
+            opt->probe_tick = now;
+            BQ25895_IO_SetInputCurrent(opt, opt->ceiling_ma);
+            return;
+        }
+    }
+
+    if (opt->vdpm_stat == BQ25895_ENABLED) {
+        if (opt->iinlim_ma >= cfg->iinlim_min_ma + cfg->iinlim_step_ma) {
+            opt->ceiling_ma = opt->iinlim_ma - cfg->iinlim_step_ma;
+            opt->probe_tick = now;
+            BQ25895_IO_SetInputCurrent(opt, opt->ceiling_ma);
+        }
+    } else if (opt->idpm_stat == BQ25895_ENABLED) {
+        if (opt->iinlim_ma + cfg->iinlim_step_ma <= limit) {
+            opt->probing = 1;
+            opt->probe_ichg_ma = opt->ichg_ma;
+            BQ25895_IO_SetInputCurrent(opt, opt->iinlim_ma + cfg->iinlim_step_ma);
+        }
+    } else {
+        opt->vbus_open_mv = opt->vbus_mv;
+    }
+
+    if (opt->vbus_open_mv == 0)
+        return;
+    vindpm = (opt->vbus_open_mv > cfg->vindpm_headroom_mv) ? opt->vbus_open_mv - cfg->vindpm_headroom_mv : 0;
+    if (vindpm < cfg->vindpm_min_mv)
+        vindpm = cfg->vindpm_min_mv;
+    if (vindpm > cfg->vindpm_max_mv)
+        vindpm = cfg->vindpm_max_mv;
+    BQ25895_IO_SetVINDPM(opt, vindpm);
+}
+
+/**
+ * @brief Start the input power optimizer.
+ * @param[out] *opt Optimizer instance.
+ * @param[in] *config Optimizer configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Switches the ADC to continuous conversion, disables the hardware ICO so it does not
+ * fight the optimizer, selects absolute VINDPM and starts from the current IINLIM setting.
+ */
+HAL_StatusTypeDef BQ25895_InputOptimizerStart(BQ25895_INPUT_OPTIMIZER *opt, const BQ25895_IO_CONFIG *config) {
+    HAL_StatusTypeDef status;
+    uint8_t temp;
+    BQ25895_CONV_RATE rate = BQ25895_ADC_CONTINUOUS;
+    BQ25895_STATE ico = BQ25895_DISABLED;
+    BQ25895_FORCE_VINDPM force = BQ25895_ABSOLUTE_VINDPM;
+    uint32_t now = HAL_GetTick();
+
+    *opt = (BQ25895_INPUT_OPTIMIZER) { 0 };
+    opt->config = (config != NULL) ? *config : BQ25895_IO_DEFAULT_CONFIG;
+    opt->ceiling_ma = opt->config.iinlim_max_ma;
+    opt->tick = now - opt->config.period_ms;
+    opt->probe_tick = now;
+
+    status = BQ25895_SetADCconversionMode(&rate);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_SetInputCurrentOptimizer(&ico);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_SetForceVINDPM(&force);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_ReadRegister(BQ25895_REG_00, &temp);
+    if (status != HAL_OK)
+        return status;
+    opt->iinlim_ma = BQ25895_DECODE(temp, IINLIM);
+    status = BQ25895_ReadRegister(BQ25895_REG_0D, &temp);
+    if (status != HAL_OK)
+        return status;
+    opt->vindpm_mv = BQ25895_DECODE(temp, VINDPM);
+    return status;
+}
+
+/**
+ * @brief Advance the input power optimizer by one step.
+ * @param[in,out] *opt Optimizer instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. Measurements are taken every period_ms,
+ * resulting IINLIM and VINDPM changes are written on the following calls as field updates, so other
+ * bits of REG_00 and REG_0D (EN_HIZ, EN_ILIM, FORCE_VINDPM) keep whatever was set meanwhile.
+ */
+HAL_StatusTypeDef BQ25895_InputOptimizerStep(BQ25895_INPUT_OPTIMIZER *opt) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_IO_BURST_LEN];
+    uint32_t now = HAL_GetTick();
+    uint8_t temp;
+
+    if (opt->pending & BQ25895_IO_PENDING_IINLIM) {
+        temp = BQ25895_ENCODE(opt->iinlim_ma, IINLIM);
+        status = BQ25895_UpdateBits(BQ25895_REG_00, BQ25895_IINLIM_MASK, &temp);
+        if (status == HAL_OK)
+            opt->pending &= ~BQ25895_IO_PENDING_IINLIM;
+        return status;
+    }
+    if (opt->pending & BQ25895_IO_PENDING_VINDPM) {
+        temp = BQ25895_ENCODE(opt->vindpm_mv, VINDPM);
+        status = BQ25895_UpdateBits(BQ25895_REG_0D, BQ25895_VINDPM_MASK, &temp);
+        if (status == HAL_OK)
+            opt->pending &= ~BQ25895_IO_PENDING_VINDPM;
+        return status;
+    }
+
+    if (now - opt->tick < opt->config.period_ms)
+        return HAL_OK;
+    opt->tick = now;
+
+    status = BQ25895_ReadRegisters(BQ25895_REG_11, regs, BQ25895_IO_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    opt->vbus_mv = BQ25895_DECODE(regs[0], VBUSV);
+    opt->ichg_ma = BQ25895_DECODE(regs[1], ICHGR);
+    opt->vdpm_stat = BQ25895_GET_FIELD(regs[2], VDPM_STAT);
+    opt->idpm_stat = BQ25895_GET_FIELD(regs[2], IDPM_STAT);
+    if (BQ25895_GET_FIELD(regs[0], VBUS_GD) == BQ25895_NO_VBUS)
+        return status;
+    BQ25895_IO_Control(opt, now);
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
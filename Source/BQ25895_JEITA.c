@@ -0,0 +1,137 @@
+/**
+ *  @brief     Software JEITA charge profile engine for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_JEITA.h"
+
+/* Typical JEITA profile for a 1C capable 2000mAh Li-ion cell */
+static const BQ25895_JEITA_BAND BQ25895_JEITA_DEFAULT_BANDS[] = {
+    {   0, 100,  512, 4208 },
+    { 100, 450, 2048, 4208 },
+    { 450, 600, 1024, 4096 }
+};
+
+static const BQ25895_JEITA_CONFIG BQ25895_JEITA_DEFAULT_CONFIG = {
+    .bands = BQ25895_JEITA_DEFAULT_BANDS,
+    .band_count = sizeof(BQ25895_JEITA_DEFAULT_BANDS) / sizeof(BQ25895_JEITA_DEFAULT_BANDS[0]),
+    .profile = BQ25895_NTC_103AT,
+    .hysteresis_dc = BQ25895_JEITA_HYSTERESIS_DC,
+    .min_dwell_ms = BQ25895_JEITA_MIN_DWELL_MS,
+    .period_ms = BQ25895_JEITA_PERIOD_MS
+};
+
+/**
+ * @brief Band for a temperature, keeping the current band until the temperature is hysteresis_dc past its edges.
+ */
+static uint8_t BQ25895_JEITA_SelectBand(const BQ25895_JEITA *jeita, int16_t temp_dc) {
+    const BQ25895_JEITA_CONFIG *cfg = &jeita->config;
+    const BQ25895_JEITA_BAND *band;
+    uint8_t i;
+
+    if (jeita->band != BQ25895_JEITA_NO_BAND) {
+        band = &cfg->bands[jeita->band];
+        if (temp_dc >= band->temp_low_dc - cfg->hysteresis_dc && temp_dc < band->temp_high_dc + cfg->hysteresis_dc)
+            return jeita->band;
+    }
+    for (i = 0; i < cfg->band_count; i++) {
+        if (temp_dc >= cfg->bands[i].temp_low_dc && temp_dc < cfg->bands[i].temp_high_dc)
+            return i;
+    }
+    return BQ25895_JEITA_NO_BAND;
+}
+
+/**
+ * @brief Write the setpoints of a band, lowering current before voltage and raising it after.
+ */
+static HAL_StatusTypeDef BQ25895_JEITA_Apply(BQ25895_JEITA *jeita, uint16_t ichg_ma, uint16_t vreg_mv) {
+    HAL_StatusTypeDef status = HAL_OK;
+    uint8_t current_first = !jeita->applied || ichg_ma < jeita->ichg_ma;
+
+    if (current_first && (!jeita->applied || ichg_ma != jeita->ichg_ma)) {
+        status = BQ25895_SetFastChargeCurrent(&ichg_ma);
+        if (status != HAL_OK)
+            return status;
+    }
+    if (!jeita->applied || vreg_mv != jeita->vreg_mv) {
+        status = BQ25895_SetChargeVoltage(&vreg_mv);
+        if (status != HAL_OK)
+            return status;
+    }
+    if (!current_first && ichg_ma != jeita->ichg_ma) {
+        status = BQ25895_SetFastChargeCurrent(&ichg_ma);
+        if (status != HAL_OK)
+            return status;
+    }
+    jeita->ichg_ma = ichg_ma;
+    jeita->vreg_mv = vreg_mv;
+    jeita->applied = 1;
+    return status;
+}
+
+/**
+ * @brief Initialise the JEITA engine.
+ * @param[out] *jeita JEITA instance.
+ * @param[in] *config Band table and timing, or NULL for the default profile.
+ * @note No setpoint is written until the first BQ25895_JEITAUpdate().
+ */
+void BQ25895_JEITAInit(BQ25895_JEITA *jeita, const BQ25895_JEITA_CONFIG *config) {
+    uint32_t now = HAL_GetTick();
+    *jeita = (BQ25895_JEITA) { 0 };
+    jeita->config = (config != NULL) ? *config : BQ25895_JEITA_DEFAULT_CONFIG;
+    jeita->band = BQ25895_JEITA_NO_BAND;
+    jeita->tick = now - jeita->config.period_ms;
+    jeita->change_tick = now - jeita->config.min_dwell_ms;
+}
+
+/**
+ * @brief Sample the battery temperature and apply the setpoints of its band.
+ * @param[in,out] *jeita JEITA instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Returns without bus traffic until period_ms has elapsed. ICHG and VREG are only written when
+ * the band changes, and band changes are rate limited to one per min_dwell_ms, except that leaving all
+ * bands (charging has to stop) is applied immediately.
+ */
+HAL_StatusTypeDef BQ25895_JEITAUpdate(BQ25895_JEITA *jeita) {
+    HAL_StatusTypeDef status;
+    const BQ25895_JEITA_BAND *band;
+    uint32_t now = HAL_GetTick();
+    uint8_t next;
+
+    if (now - jeita->tick < jeita->config.period_ms)
+        return HAL_OK;
+    jeita->tick = now;
+
+    status = BQ25895_GetTemperature(jeita->config.profile, &jeita->temp_dc);
+    if (status != HAL_OK)
+        return status;
+
+    next = BQ25895_JEITA_SelectBand(jeita, jeita->temp_dc);
+    if (jeita->applied && next == jeita->band)
+        return status;
+    if (jeita->applied && next != BQ25895_JEITA_NO_BAND && now - jeita->change_tick < jeita->config.min_dwell_ms)
+        return status;
+
+    if (next == BQ25895_JEITA_NO_BAND) {
+        status = BQ25895_JEITA_Apply(jeita, 0, jeita->applied ? jeita->vreg_mv : jeita->config.bands[0].vreg_mv);
+    } else {
+        band = &jeita->config.bands[next];
+        status = BQ25895_JEITA_Apply(jeita, band->ichg_ma, band->vreg_mv);
+    }
+    if (status != HAL_OK)
+        return status;
+    jeita->band = next;
+    jeita->change_tick = now;
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,170 @@
+/**
+ *  @brief     Pluggable locking for the BQ25895 register I/O.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Lock.h"
+
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+#include "task.h"
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+#include <sched.h>
+#endif
+
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+static uint32_t BQ25895_lock_primask;
+static uint8_t BQ25895_lock_nesting;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+static pthread_mutex_t BQ25895_lock_section = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local void *BQ25895_lock_local;
+#endif
+#if BQ25895_LOCK_IMPL != BQ25895_LOCK_PTHREAD
+/* Single context, or FreeRTOS before the scheduler runs */
+static void *BQ25895_lock_local;
+#endif
+
+/**
+ * @brief Initialise a lock.
+ * @param[out] *lock Lock instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Call before any other context can use the lock, e.g. before the scheduler is started.
+ */
+HAL_StatusTypeDef BQ25895_LockInit(BQ25895_LOCK *lock) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    lock->handle = xSemaphoreCreateMutexStatic(&lock->buffer);
+    return (lock->handle != NULL) ? HAL_OK : HAL_ERROR;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    return (pthread_mutex_init(&lock->mutex, NULL) == 0) ? HAL_OK : HAL_ERROR;
+#else
+    *lock = (BQ25895_LOCK) { 0 };
+    return HAL_OK;
+#endif
+}
+
+/**
+ * @brief Take a lock, blocking until it is free where waiting can succeed.
+ * @param[in,out] *lock Lock instance.
+ * @retval HAL_OK when taken, HAL_BUSY if the lock is held and waiting for it cannot help
+ * @note May be held across I2C transfers. With #BQ25895_LOCK_CRITICAL interrupts stay enabled meanwhile,
+ * a held lock means an interrupt preempted its holder, so the interrupt gets HAL_BUSY instead of waiting
+ * forever. Other implementations always return HAL_OK.
+ */
+HAL_StatusTypeDef BQ25895_LockTake(BQ25895_LOCK *lock) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    xSemaphoreTake(lock->handle, portMAX_DELAY);
+    return HAL_OK;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    pthread_mutex_lock(&lock->mutex);
+    return HAL_OK;
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+    HAL_StatusTypeDef status = HAL_BUSY;
+    BQ25895_LockEnter();
+    if (!lock->taken) {
+        lock->taken = 1;
+        status = HAL_OK;
+    }
+    BQ25895_LockExit();
+    return status;
+#else
+    (void) lock;
+    return HAL_OK;
+#endif
+}
+
+/**
+ * @brief Release a lock taken with BQ25895_LockTake() returning HAL_OK.
+ * @param[in,out] *lock Lock instance.
+ */
+void BQ25895_LockGive(BQ25895_LOCK *lock) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    xSemaphoreGive(lock->handle);
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    pthread_mutex_unlock(&lock->mutex);
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+    lock->taken = 0;
+#else
+    (void) lock;
+#endif
+}
+
+/**
+ * @brief Enter the short global critical section guarding shared driver state such as the bus queues.
+ * @note Only a few instructions are run inside, never an I2C transfer. Nesting is allowed with
+ * #BQ25895_LOCK_CRITICAL (and by FreeRTOS), not with #BQ25895_LOCK_PTHREAD.
+ */
+void BQ25895_LockEnter(void) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    taskENTER_CRITICAL();
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    pthread_mutex_lock(&BQ25895_lock_section);
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (BQ25895_lock_nesting++ == 0)
+        BQ25895_lock_primask = primask;
+#endif
+}
+
+/**
+ * @brief Leave the critical section entered with BQ25895_LockEnter().
+ */
+void BQ25895_LockExit(void) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    taskEXIT_CRITICAL();
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    pthread_mutex_unlock(&BQ25895_lock_section);
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_CRITICAL
+    if (--BQ25895_lock_nesting == 0)
+        __set_PRIMASK(BQ25895_lock_primask);
+#endif
+}
+
+/**
+ * @brief Let other contexts run while waiting for the bus.
+ */
+void BQ25895_LockYield(void) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    taskYIELD();
+#elif BQ25895_LOCK_IMPL == BQ25895_LOCK_PTHREAD
+    sched_yield();
+#endif
+}
+
+/**
+ * @brief Get the pointer stored for the calling context with BQ25895_LockSetLocal().
+ * @retval Pointer, NULL if the context never stored one
+ * @note One slot per thread (#BQ25895_LOCK_PTHREAD) or task (#BQ25895_LOCK_FREERTOS, slot
+ * #BQ25895_LOCK_TLS_INDEX). Without threads there is one slot, an interrupt using it must restore it.
+ */
+void *BQ25895_LockGetLocal(void) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        return pvTaskGetThreadLocalStoragePointer(NULL, BQ25895_LOCK_TLS_INDEX);
+#endif
+    return BQ25895_lock_local;
+}
+
+/**
+ * @brief Store a pointer for the calling context, other contexts keep their own.
+ * @param[in] *value Pointer to store.
+ */
+void BQ25895_LockSetLocal(void *value) {
+#if BQ25895_LOCK_IMPL == BQ25895_LOCK_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        vTaskSetThreadLocalStoragePointer(NULL, BQ25895_LOCK_TLS_INDEX, value);
+        return;
+    }
+#endif
+    BQ25895_lock_local = value;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,180 @@
+/**
+ *  @brief     Solar maximum power point tracking on top of the BQ25895 absolute VINDPM control.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_MPPT.h"
+
+/* REG_0E (BATV) up to and including REG_12 (ICHGR) in one ADC burst */
+#define BQ25895_MPPT_BURST_LEN      (BQ25895_REG_12 - BQ25895_REG_0E + 1)
+
+static const BQ25895_MPPT_CONFIG BQ25895_MPPT_DEFAULT_CONFIG = {
+    .mode = BQ25895_MPPT_PERTURB_OBSERVE,
+    .step_mv = BQ25895_MPPT_STEP_MV,
+    .period_ms = BQ25895_MPPT_PERIOD_MS,
+    .vindpm_min_mv = BQ25895_MPPT_VINDPM_MIN_MV,
+    .vindpm_max_mv = BQ25895_MPPT_VINDPM_MAX_MV,
+    .voc_ratio_q8 = BQ25895_MPPT_VOC_RATIO_Q8,
+    .voc_interval_ms = BQ25895_MPPT_VOC_INTERVAL_MS,
+    .voc_settle_ms = BQ25895_MPPT_VOC_SETTLE_MS
+};
+
+static void BQ25895_MPPT_SetVINDPM(BQ25895_MPPT *mppt, int32_t voltage_mv) {
+    if (voltage_mv < mppt->config.vindpm_min_mv)
+        voltage_mv = mppt->config.vindpm_min_mv;
+    if (voltage_mv > mppt->config.vindpm_max_mv)
+        voltage_mv = mppt->config.vindpm_max_mv;
+    voltage_mv -= voltage_mv % BQ25895_VINDPM_LSB;
+    if (voltage_mv == mppt->vindpm_mv)
+        return;
+    mppt->vindpm_mv = voltage_mv;
+    mppt->pending = 1;
+}
+
+/**
+ * @brief Perturb and observe: keep moving VINDPM in the same direction while charge power increases.
+ */
+static void BQ25895_MPPT_PerturbObserve(BQ25895_MPPT *mppt, uint32_t power_mw) {
+    if (power_mw < mppt->power_mw)
+        mppt->direction = -mppt->direction;
+    mppt->power_mw = power_mw;
+    BQ25895_MPPT_SetVINDPM(mppt, (int32_t)mppt->vindpm_mv + mppt->direction * (int32_t)mppt->config.step_mv);
+}
+
+static HAL_StatusTypeDef BQ25895_MPPT_Track(BQ25895_MPPT *mppt, uint32_t now) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_MPPT_BURST_LEN];
+    uint32_t power_mw;
+
+    if (mppt->config.voc_interval_ms != 0 && now - mppt->voc_tick >= mppt->config.voc_interval_ms) {
+        mppt->phase = BQ25895_MPPT_VOC_OPEN;
+        return HAL_OK;
+    }
+    if (now - mppt->tick < mppt->config.period_ms)
+        return HAL_OK;
+    mppt->tick = now;
+
+    status = BQ25895_ReadRegisters(BQ25895_REG_0E, regs, BQ25895_MPPT_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    mppt->vbat_mv = BQ25895_DECODE(regs[BQ25895_REG_0E - BQ25895_REG_0E], BATV);
+    mppt->vbus_mv = BQ25895_DECODE(regs[BQ25895_REG_11 - BQ25895_REG_0E], VBUSV);
+    mppt->ichg_ma = BQ25895_DECODE(regs[BQ25895_REG_12 - BQ25895_REG_0E], ICHGR);
+    power_mw = ((uint32_t)mppt->vbat_mv * mppt->ichg_ma) / 1000;
+
+    if (mppt->config.mode == BQ25895_MPPT_PERTURB_OBSERVE)
+        BQ25895_MPPT_PerturbObserve(mppt, power_mw);
+    else
+        mppt->power_mw = power_mw;
+    return status;
+}
+
+/**
+ * @brief Open-circuit voltage measurement: the input is put in HIZ, VBUS is sampled once it has
+ * settled, and the input is released again. Every phase is one register access, EN_HIZ is toggled as a
+ * field update so IINLIM and EN_ILIM changes made meanwhile by other modules are kept.
+ */
+static HAL_StatusTypeDef BQ25895_MPPT_MeasureVoc(BQ25895_MPPT *mppt, uint32_t now) {
+    HAL_StatusTypeDef status;
+    uint8_t temp;
+
+    switch (mppt->phase) {
+    case BQ25895_MPPT_VOC_OPEN:
+        temp = BQ25895_ENABLED << BQ25895_ENHIZ_BIT;
+        status = BQ25895_UpdateBits(BQ25895_REG_00, BQ25895_ENHIZ_MASK, &temp);
+        if (status == HAL_OK) {
+            mppt->phase = BQ25895_MPPT_VOC_SETTLE;
+            mppt->voc_tick = now;
+        }
+        return status;
+    case BQ25895_MPPT_VOC_SETTLE:
+        if (now - mppt->voc_tick < mppt->config.voc_settle_ms)
+            return HAL_OK;
+        status = BQ25895_ReadRegister(BQ25895_REG_11, &temp);
+        if (status != HAL_OK)
+            return status;
+        mppt->voc_mv = BQ25895_DECODE(temp, VBUSV);
+        mppt->phase = BQ25895_MPPT_VOC_CLOSE;
+        return status;
+    default:
+        temp = BQ25895_DISABLED << BQ25895_ENHIZ_BIT;
+        status = BQ25895_UpdateBits(BQ25895_REG_00, BQ25895_ENHIZ_MASK, &temp);
+        if (status != HAL_OK)
+            return status;
+        mppt->phase = BQ25895_MPPT_TRACK;
+        mppt->voc_tick = now;
+        mppt->power_mw = 0;
+        BQ25895_MPPT_SetVINDPM(mppt, ((uint32_t)mppt->voc_mv * mppt->config.voc_ratio_q8) >> 8);
+        return status;
+    }
+}
+
+/**
+ * @brief Start maximum power point tracking.
+ * @param[out] *mppt MPPT instance.
+ * @param[in] *config MPPT configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Switches the ADC to continuous conversion and VINDPM to absolute mode. The first
+ * step measures the panel open-circuit voltage to seed the operating point in both modes.
+ */
+HAL_StatusTypeDef BQ25895_MPPTStart(BQ25895_MPPT *mppt, const BQ25895_MPPT_CONFIG *config) {
+    HAL_StatusTypeDef status;
+    uint8_t temp;
+    BQ25895_CONV_RATE rate = BQ25895_ADC_CONTINUOUS;
+    BQ25895_FORCE_VINDPM force = BQ25895_ABSOLUTE_VINDPM;
+    uint32_t now = HAL_GetTick();
+
+    *mppt = (BQ25895_MPPT) { 0 };
+    mppt->config = (config != NULL) ? *config : BQ25895_MPPT_DEFAULT_CONFIG;
+    mppt->phase = BQ25895_MPPT_VOC_OPEN;
+    mppt->direction = 1;
+    mppt->tick = now;
+    mppt->voc_tick = now;
+
+    status = BQ25895_SetADCconversionMode(&rate);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_SetForceVINDPM(&force);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_ReadRegister(BQ25895_REG_0D, &temp);
+    if (status != HAL_OK)
+        return status;
+    mppt->vindpm_mv = BQ25895_DECODE(temp, VINDPM);
+    return status;
+}
+
+/**
+ * @brief Advance maximum power point tracking by one step.
+ * @param[in,out] *mppt MPPT instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. Each iteration uses one ADC burst
+ * (BATV, VBUSV and ICHGR) and, if the operating point moved, one VINDPM field update on the next call.
+ */
+HAL_StatusTypeDef BQ25895_MPPTStep(BQ25895_MPPT *mppt) {
+    HAL_StatusTypeDef status;
+    uint32_t now = HAL_GetTick();
+    uint8_t temp;
+
+    if (mppt->pending) {
+        temp = BQ25895_ENCODE(mppt->vindpm_mv, VINDPM);
+        status = BQ25895_UpdateBits(BQ25895_REG_0D, BQ25895_VINDPM_MASK, &temp);
+        if (status == HAL_OK)
+            mppt->pending = 0;
+        return status;
+    }
+    if (mppt->phase == BQ25895_MPPT_TRACK)
+        return BQ25895_MPPT_Track(mppt, now);
+    return BQ25895_MPPT_MeasureVoc(mppt, now);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+/**
+ *  @brief     NTC percentage to temperature conversion for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_NTC.h"
+
+/* BHOT and BCOLD thresholds as TS percentage of REGN x100, indexed by the register encoding */
+static const uint16_t BQ25895_BHOT_PCT[] = { 3475, 3775, 3125 };
+static const uint16_t BQ25895_BCOLD_PCT[] = { 7700, 8000 };
+
+static uint16_t BQ25895_NTC_Distance(uint16_t a, uint16_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+/**
+ * @brief Convert a TS reading to temperature.
+ * @param[in] profile NTC and bias network, see #BQ25895_NTC_PROFILE
+ * @param[in] percent TS voltage as percentage of REGN x100, as returned by BQ25895_GetTSVoltage()
+ * @retval Temperature in 0.1C, clamped to the table range
+ * @note Binary search plus one linear interpolation, integer only.
+ */
+int16_t BQ25895_NTCToTemperature(BQ25895_NTC_PROFILE profile, uint16_t percent) {
+    const BQ25895_NTC_TABLE *table = &BQ25895_NTC_TABLES[profile];
+    const uint16_t *pct = table->ts_pct;
+    uint8_t lo = 0;
+    uint8_t hi = table->count - 1;
+    uint8_t mid;
+
+    if (percent >= pct[lo])
+        return table->t0_dc;
+    if (percent <= pct[hi])
+        return table->t0_dc + hi * table->step_dc;
+
+    /* Invariant: pct[lo] > percent >= pct[hi] */
+    while (hi - lo > 1) {
+        mid = (lo + hi) / 2;
+        if (pct[mid] > percent)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return table->t0_dc + lo * table->step_dc
+            + ((int32_t)table->step_dc * (pct[lo] - percent)) / (pct[lo] - pct[hi]);
+}
+
+/**
+ * @brief Convert a temperature to the expected TS reading.
+ * @param[in] profile NTC and bias network, see #BQ25895_NTC_PROFILE
+ * @param[in] temp_dc Temperature in 0.1C
+ * @retval TS voltage as percentage of REGN x100, clamped to the table range
+ */
+uint16_t BQ25895_NTCToPercent(BQ25895_NTC_PROFILE profile, int16_t temp_dc) {
+    const BQ25895_NTC_TABLE *table = &BQ25895_NTC_TABLES[profile];
+    const uint16_t *pct = table->ts_pct;
+    int32_t offset = temp_dc - table->t0_dc;
+    int32_t index;
+    int32_t frac;
+
+    if (offset <= 0)
+        return pct[0];
+    index = offset / table->step_dc;
+    if (index >= table->count - 1)
+        return pct[table->count - 1];
+    frac = offset % table->step_dc;
+    return pct[index] - ((int32_t)(pct[index] - pct[index + 1]) * frac) / table->step_dc;
+}
+
+/**
+ * @brief Pick the boost mode hot threshold (BHOT[1-0]) closest to a temperature.
+ * @param[in] profile NTC and bias network, see #BQ25895_NTC_PROFILE
+ * @param[in] temp_dc Wanted hot threshold in 0.1C
+ * @retval #BQ25895_BHOT_34_75_PERCENT, #BQ25895_BHOT_37_75_PERCENT or #BQ25895_BHOT_31_25_PERCENT
+ */
+BQ25895_BHOT BQ25895_NTCToBoostHotTH(BQ25895_NTC_PROFILE profile, int16_t temp_dc) {
+    uint16_t percent = BQ25895_NTCToPercent(profile, temp_dc);
+    BQ25895_BHOT best = BQ25895_BHOT_34_75_PERCENT;
+    uint8_t i;
+    for (i = 1; i < sizeof(BQ25895_BHOT_PCT) / sizeof(BQ25895_BHOT_PCT[0]); i++) {
+        if (BQ25895_NTC_Distance(BQ25895_BHOT_PCT[i], percent) < BQ25895_NTC_Distance(BQ25895_BHOT_PCT[best], percent))
+            best = (BQ25895_BHOT)i;
+    }
+    return best;
+}
+
+/**
+ * @brief Pick the boost mode cold threshold (BCOLD) closest to a temperature.
+ * @param[in] profile NTC and bias network, see #BQ25895_NTC_PROFILE
+ * @param[in] temp_dc Wanted cold threshold in 0.1C
+ * @retval #BQ25895_BCOLD_77_PERCENT or #BQ25895_BCOLD_80_PERCENT
+ */
+BQ25895_BCOLD BQ25895_NTCToBoostColdTH(BQ25895_NTC_PROFILE profile, int16_t temp_dc) {
+    uint16_t percent = BQ25895_NTCToPercent(profile, temp_dc);
+    if (BQ25895_NTC_Distance(BQ25895_BCOLD_PCT[BQ25895_BCOLD_80_PERCENT], percent)
+            < BQ25895_NTC_Distance(BQ25895_BCOLD_PCT[BQ25895_BCOLD_77_PERCENT], percent))
+        return BQ25895_BCOLD_80_PERCENT;
+    return BQ25895_BCOLD_77_PERCENT;
+}
+
+/**
+ * @brief Get battery temperature from the TS ADC reading (TSPCT[6-0])
+ * @param[in] profile NTC and bias network, see #BQ25895_NTC_PROFILE
+ * @param[out] *temp_dc Temperature in 0.1C
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ */
+HAL_StatusTypeDef BQ25895_GetTemperature(BQ25895_NTC_PROFILE profile, int16_t *temp_dc) {
+    HAL_StatusTypeDef status;
+    uint16_t percent;
+    status = BQ25895_GetTSVoltage(&percent);
+    if (status != HAL_OK)
+        return status;
+    *temp_dc = BQ25895_NTCToTemperature(profile, percent);
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+/**
+ *  @brief     NTC lookup tables for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ *  @note      Generated by Tools/ntc_table.py, do not edit.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_NTC.h"
+
+/* R25 = 10000, B = 3435, RT1 = 5230, RT2 = 30100 */
+static const uint16_t BQ25895_NTC_103AT_PCT[] = {
+    8369, 8316, 8248, 8163, 8057, 7927, 7772, 7588, 7375, 7132,
+    6860, 6560, 6237, 5894, 5536, 5171, 4803, 4439, 4083, 3741,
+    3415, 3108, 2822, 2558, 2315, 2093, 1892, 1709, 1545,
+};
+
+/* R25 = 10000, B = 3380, RT1 = 5230, RT2 = 30100 */
+static const uint16_t BQ25895_NTC_NCP15XH103_PCT[] = {
+    8362, 8307, 8237, 8150, 8042, 7911, 7755, 7571, 7358, 7116,
+    6846, 6550, 6231, 5894, 5542, 5183, 4822, 4464, 4114, 3776,
+    3455, 3151, 2868, 2605, 2364, 2142, 1941, 1758, 1592,
+};
+
+/* R25 = 100000, B = 4250, RT1 = 52300, RT2 = 301000 */
+static const uint16_t BQ25895_NTC_100K_B4250_PCT[] = {
+    8449, 8416, 8371, 8310, 8229, 8122, 7985, 7813, 7601, 7345,
+    7045, 6699, 6314, 5894, 5448, 4989, 4527, 4073, 3637, 3227,
+    2847, 2502, 2191, 1914, 1670, 1456, 1269, 1107, 966,
+};
+
+const BQ25895_NTC_TABLE BQ25895_NTC_TABLES[BQ25895_NTC_PROFILE_COUNT] = {
+    [BQ25895_NTC_103AT] = { -400, 50, sizeof(BQ25895_NTC_103AT_PCT) / sizeof(BQ25895_NTC_103AT_PCT[0]), BQ25895_NTC_103AT_PCT },
+    [BQ25895_NTC_NCP15XH103] = { -400, 50, sizeof(BQ25895_NTC_NCP15XH103_PCT) / sizeof(BQ25895_NTC_NCP15XH103_PCT[0]), BQ25895_NTC_NCP15XH103_PCT },
+    [BQ25895_NTC_100K_B4250] = { -400, 50, sizeof(BQ25895_NTC_100K_B4250_PCT) / sizeof(BQ25895_NTC_100K_B4250_PCT[0]), BQ25895_NTC_100K_B4250_PCT },
+};
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,223 @@
+/**
+ *  @brief     OTG boost mode power manager for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_OTG.h"
+
+/* REG_0C (faults) up to and including REG_11 (VBUSV) in one burst */
+#define BQ25895_OTG_BURST_LEN       (BQ25895_REG_11 - BQ25895_REG_0C + 1)
+
+static const BQ25895_OTG_CONFIG BQ25895_OTG_DEFAULT_CONFIG = {
+    .profile = BQ25895_NTC_103AT,
+    .hot_dc = BQ25895_OTG_HOT_DC,
+    .cold_dc = BQ25895_OTG_COLD_DC,
+    .hyst_dc = BQ25895_OTG_HYST_DC,
+    .heavy_droop_mv = BQ25895_OTG_HEAVY_DROOP_MV,
+    .heavy_sys_droop_mv = BQ25895_OTG_HEAVY_SYS_DROOP_MV,
+    .idle_droop_mv = BQ25895_OTG_IDLE_DROOP_MV,
+    .light_freq = BQ25895_BOOST_FREQ_500K,
+    .heavy_freq = BQ25895_BOOST_FREQ_1500K,
+    .idle_ms = BQ25895_OTG_IDLE_MS,
+    .period_ms = BQ25895_OTG_PERIOD_MS,
+    .fault_backoff_ms = BQ25895_OTG_FAULT_BACKOFF_MS,
+    .fault_max_backoff_ms = BQ25895_OTG_FAULT_MAX_BACKOFF_MS,
+    .fault_clear_ms = BQ25895_OTG_FAULT_CLEAR_MS
+};
+
+static HAL_StatusTypeDef BQ25895_OTG_Stop(BQ25895_OTG_MANAGER *otg) {
+    otg->running = 0;
+    return BQ25895_QueueUpdate(&otg->updates, BQ25895_REG_03, BQ25895_OTG_CONFIG_MASK,
+            BQ25895_DISABLED << BQ25895_OTG_CONFIG_BIT);
+}
+
+/**
+ * @brief Start boost, writing BOOST_FREQ first while OTG is still off if the frequency has to change.
+ */
+static HAL_StatusTypeDef BQ25895_OTG_Run(BQ25895_OTG_MANAGER *otg, BQ25895_BOOST_FREQ freq, uint32_t now) {
+    HAL_StatusTypeDef status;
+    if (freq != otg->freq) {
+        status = BQ25895_QueueUpdate(&otg->updates, BQ25895_REG_02, BQ25895_BOOST_FREQ_MASK,
+                freq << BQ25895_BOOST_FREQ_BIT);
+        if (status != HAL_OK)
+            return status;
+        otg->freq = freq;
+    }
+    otg->running = 1;
+    otg->start_tick = now;
+    otg->idle_tick = now;
+    return BQ25895_QueueUpdate(&otg->updates, BQ25895_REG_03, BQ25895_OTG_CONFIG_MASK,
+            BQ25895_ENABLED << BQ25895_OTG_CONFIG_BIT);
+}
+
+/**
+ * @brief Track faults, temperature and load from one burst, queueing the register updates that follow.
+ * @retval HAL_StatusTypeDef HAL_ERROR if an update could not be queued
+ */
+static HAL_StatusTypeDef BQ25895_OTG_Update(BQ25895_OTG_MANAGER *otg, const uint8_t *regs, uint32_t now) {
+    const BQ25895_OTG_CONFIG *cfg = &otg->config;
+    uint8_t fault = regs[0];
+    uint16_t ts_pct = BQ25895_DECODE(regs[BQ25895_REG_10 - BQ25895_REG_0C], TSPCT);
+    uint8_t ntc = BQ25895_GET_FIELD(fault, FAULT_NTC);
+    HAL_StatusTypeDef status;
+    BQ25895_BOOST_FREQ freq;
+
+    otg->vbat_mv = BQ25895_DECODE(regs[BQ25895_REG_0E - BQ25895_REG_0C], BATV);
+    otg->sysv_mv = BQ25895_DECODE(regs[BQ25895_REG_0F - BQ25895_REG_0C], SYSV);
+    otg->vbus_mv = BQ25895_DECODE(regs[BQ25895_REG_11 - BQ25895_REG_0C], VBUSV);
+    otg->temp_dc = BQ25895_NTCToTemperature(cfg->profile, ts_pct);
+
+    /* Software temperature window on top of the BHOT/BCOLD hardware limits */
+    if (otg->temp_dc > cfg->hot_dc || otg->temp_dc < cfg->cold_dc
+            || ntc == BQ25895_BOOST_TS_HOT || ntc == BQ25895_BOOST_TS_COLD)
+        otg->temp_block = 1;
+    else if (otg->temp_dc <= cfg->hot_dc - cfg->hyst_dc && otg->temp_dc >= cfg->cold_dc + cfg->hyst_dc)
+        otg->temp_block = 0;
+
+    if (otg->faults != 0 && now - otg->fault_tick >= cfg->fault_clear_ms) {
+        otg->faults = 0;
+        otg->backoff_ms = cfg->fault_backoff_ms;
+    }
+
+    if (!otg->running) {
+        if (otg->requested == BQ25895_ENABLED && !otg->temp_block
+                && (otg->faults == 0 || now - otg->fault_tick >= otg->backoff_ms))
+            return BQ25895_OTG_Run(otg, otg->heavy ? cfg->heavy_freq : cfg->light_freq, now);
+        return HAL_OK;
+    }
+
+    if (fault & BQ25895_BOOST_FAULT_MASK) {
+        /* Overload or VBUS short: restart after a growing delay, at the heavy load frequency */
+        if (otg->faults != 0 && otg->backoff_ms < cfg->fault_max_backoff_ms)
+            otg->backoff_ms <<= 1;
+        if (otg->backoff_ms > cfg->fault_max_backoff_ms)
+            otg->backoff_ms = cfg->fault_max_backoff_ms;
+        if (otg->faults < 0xFF)
+            otg->faults++;
+        otg->fault_tick = now;
+        otg->heavy = 1;
+        return BQ25895_OTG_Stop(otg);
+    }
+    if (otg->requested != BQ25895_ENABLED || otg->temp_block)
+        return BQ25895_OTG_Stop(otg);
+
+    /* VBUS droop shows the output load, SYSV below the resting battery the current drawn to supply it */
+    if (otg->vbus_mv + cfg->heavy_droop_mv <= otg->boostv_mv
+            || (cfg->heavy_sys_droop_mv != 0 && otg->vbat_rest_mv != 0
+                    && otg->sysv_mv + cfg->heavy_sys_droop_mv <= otg->vbat_rest_mv))
+        otg->heavy = 1;
+    if (otg->vbus_mv + cfg->idle_droop_mv < otg->boostv_mv) {
+        otg->idle_tick = now;
+        return HAL_OK;
+    }
+    /* No load: a short boost restart is harmless, so this is the moment to change frequency */
+    otg->vbat_rest_mv = otg->vbat_mv;
+    if (otg->heavy)
+        freq = cfg->heavy_freq;
+    else if (now - otg->idle_tick >= cfg->idle_ms)
+        freq = cfg->light_freq;
+    else
+        return HAL_OK;
+    otg->heavy = 0;
+    if (freq == otg->freq)
+        return HAL_OK;
+    status = BQ25895_OTG_Stop(otg);
+    if (status != HAL_OK)
+        return status;
+    return BQ25895_OTG_Run(otg, freq, now);
+}
+
+/**
+ * @brief Start the OTG manager.
+ * @param[out] *otg OTG manager instance.
+ * @param[in] *config OTG configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Programs BHOT/BCOLD closest to the configured temperature window, switches the ADC to
+ * continuous conversion and takes over boost control. Boost stays off until BQ25895_OTGRequest().
+ */
+HAL_StatusTypeDef BQ25895_OTGStart(BQ25895_OTG_MANAGER *otg, const BQ25895_OTG_CONFIG *config) {
+    HAL_StatusTypeDef status;
+    BQ25895_CONV_RATE rate = BQ25895_ADC_CONTINUOUS;
+    BQ25895_STATE state = BQ25895_DISABLED;
+    BQ25895_BHOT bhot;
+    BQ25895_BCOLD bcold;
+
+    *otg = (BQ25895_OTG_MANAGER) { 0 };
+    otg->config = (config != NULL) ? *config : BQ25895_OTG_DEFAULT_CONFIG;
+    /* VBUSV resolution, a smaller idle droop would never see the no load state */
+    if (otg->config.idle_droop_mv < BQ25895_VBUSV_LSB)
+        otg->config.idle_droop_mv = BQ25895_VBUSV_LSB;
+    otg->requested = BQ25895_DISABLED;
+    otg->backoff_ms = otg->config.fault_backoff_ms;
+    otg->tick = HAL_GetTick() - otg->config.period_ms;
+
+    bhot = BQ25895_NTCToBoostHotTH(otg->config.profile, otg->config.hot_dc);
+    status = BQ25895_SetBoostHotTempTH(&bhot);
+    if (status != HAL_OK)
+        return status;
+    bcold = BQ25895_NTCToBoostColdTH(otg->config.profile, otg->config.cold_dc);
+    status = BQ25895_SetBoostColdTempTH(&bcold);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_SetADCconversionMode(&rate);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_SetOTGmode(&state);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_GetBoostFreq(&otg->freq);
+    if (status != HAL_OK)
+        return status;
+    return BQ25895_GetBoostModeVoltage(&otg->boostv_mv);
+}
+
+/**
+ * @brief Ask for boost mode to be turned on or off.
+ * @param[in,out] *otg OTG manager instance.
+ * @param[in] state #BQ25895_ENABLED or #BQ25895_DISABLED
+ * @note Takes effect on the following steps. Boost is held off while the battery is outside the
+ * temperature window or a BOOST_FAULT back off is running.
+ */
+void BQ25895_OTGRequest(BQ25895_OTG_MANAGER *otg, BQ25895_STATE state) {
+    otg->requested = state;
+}
+
+/**
+ * @brief Advance the OTG manager by one step.
+ * @param[in,out] *otg OTG manager instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. The load is judged from the VBUS droop below
+ * BOOSTV and the SYSV droop below the battery voltage seen at no load. BOOST_FREQ can only be written with
+ * OTG off, so a running boost is only restarted while there is no load, i.e. with VBUS within idle_droop_mv
+ * of BOOSTV: at the first no load reading after a heavy load to move to heavy_freq, after idle_ms without
+ * load to move back to light_freq. A restart after BOOST_FAULT uses heavy_freq.
+ * Register updates are queued and run one per step, see BQ25895_RunQueuedUpdate().
+ */
+HAL_StatusTypeDef BQ25895_OTGStep(BQ25895_OTG_MANAGER *otg) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_OTG_BURST_LEN];
+    uint32_t now = HAL_GetTick();
+
+    if (otg->updates.count != 0)
+        return BQ25895_RunQueuedUpdate(&otg->updates);
+
+    if (now - otg->tick < otg->config.period_ms)
+        return HAL_OK;
+    otg->tick = now;
+
+    status = BQ25895_ReadRegisters(BQ25895_REG_0C, regs, BQ25895_OTG_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    return BQ25895_OTG_Update(otg, regs, now);
+}
+
+#ifdef __cplusplus
+}
+#endif
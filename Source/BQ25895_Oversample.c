@@ -0,0 +1,100 @@
+/**
+ *  @brief     Oversampling and decimation of the BQ25895 ADC readings.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_Oversample.h"
+
+static uint32_t BQ25895_OS_Sqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Initialise an oversampling filter for one ADC channel.
+ * @param[out] *os Filter instance.
+ * @param[in] base_mv Channel offset, e.g. #BQ25895_BATV_BASE
+ * @param[in] lsb_mv Channel LSB, e.g. #BQ25895_BATV_LSB
+ * @param[in] extra_bits Resolution to gain, 1 - #BQ25895_OVERSAMPLE_MAX_BITS
+ */
+void BQ25895_OversampleInit(BQ25895_OVERSAMPLE *os, uint16_t base_mv, uint16_t lsb_mv, uint8_t extra_bits) {
+    *os = (BQ25895_OVERSAMPLE) { 0 };
+    if (extra_bits < 1)
+        extra_bits = 1;
+    if (extra_bits > BQ25895_OVERSAMPLE_MAX_BITS)
+        extra_bits = BQ25895_OVERSAMPLE_MAX_BITS;
+    os->base_uv = (uint32_t)base_mv * 1000;
+    os->lsb_uv = (uint32_t)lsb_mv * 1000;
+    os->extra_bits = extra_bits;
+}
+
+/**
+ * @brief Add one ADC sample.
+ * @param[in,out] *os Filter instance.
+ * @param[in] code Raw ADC code, e.g. BQ25895_GET_FIELD(reg_0e, BATV)
+ * @retval 1 when this sample completed a block and a new estimate is available, else 0
+ * @note O(1), only running sums are kept. Samples must come from separate conversions; in continuous
+ * mode the ADC updates once per second, so an output takes 4^extra_bits seconds.
+ * @note Oversampling only resolves below one LSB when the signal carries at least about half an LSB of
+ * noise. If the block shows less spread than that, the confidence is reported as the plain quantisation
+ * error (LSB / sqrt(12)) instead of the standard error.
+ */
+uint8_t BQ25895_OversampleAdd(BQ25895_OVERSAMPLE *os, uint8_t code) {
+    uint8_t shift = 2 * os->extra_bits;
+    uint32_t n = 1UL << shift;
+    uint32_t spread;
+
+    os->sum += code;
+    os->sum_sq += (uint32_t)code * code;
+    if (++os->count < n)
+        return 0;
+
+    /* n^2 x variance, in codes^2 */
+    spread = n * os->sum_sq - os->sum * os->sum;
+    os->estimate_uv = os->base_uv + ((os->sum * os->lsb_uv) >> shift);
+    if (4 * spread < n * n)
+        os->confidence_uv = (os->lsb_uv * 289) / 1000;
+    else
+        os->confidence_uv = (os->lsb_uv * BQ25895_OS_Sqrt(spread)) >> (3 * os->extra_bits);
+
+    os->count = 0;
+    os->sum = 0;
+    os->sum_sq = 0;
+    os->ready = 1;
+    return 1;
+}
+
+/**
+ * @brief Get the last decimated estimate.
+ * @param[in] *os Filter instance.
+ * @param[out] *confidence_uv One standard error of the estimate in uV, may be NULL
+ * @retval Estimated value in uV, 0 until the first block completed
+ */
+uint32_t BQ25895_OversampleGet(const BQ25895_OVERSAMPLE *os, uint32_t *confidence_uv) {
+    if (confidence_uv != NULL)
+        *confidence_uv = os->confidence_uv;
+    return os->estimate_uv;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+/**
+ *  @brief     Fast plug-in handling from input detection to optimal input current for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_PlugIn.h"
+
+/* REG_0B (status) up to and including REG_14 (ICO_OPTIMIZED), read in one burst once the input is detected */
+#define BQ25895_PLUGIN_ICO_BURST_LEN    (BQ25895_REG_14 - BQ25895_REG_0B + 1)
+
+static const BQ25895_PLUGIN_CONFIG BQ25895_PLUGIN_DEFAULT_CONFIG = {
+    .poll_interval_ms = BQ25895_PLUGIN_POLL_INTERVAL_MS,
+    .detect_timeout_ms = BQ25895_PLUGIN_DETECT_TIMEOUT_MS,
+    .ico_min_poll_ms = BQ25895_PLUGIN_ICO_MIN_POLL_MS,
+    .ico_max_poll_ms = BQ25895_PLUGIN_ICO_MAX_POLL_MS,
+    .ico_timeout_ms = BQ25895_PLUGIN_ICO_TIMEOUT_MS,
+    .retrigger_ms = BQ25895_PLUGIN_RETRIGGER_MS,
+    .ico_holdoff_ms = BQ25895_PLUGIN_ICO_HOLDOFF_MS,
+    .run_ico = BQ25895_ENABLED
+};
+
+/* Starting IINLIM per VBUS_STAT, the datasheet input current limits of each source type */
+static const uint16_t BQ25895_PLUGIN_LIMIT_MA[] = {
+    [BQ25895_NO_INPUT] = 500,
+    [BQ25895_USB_SDP] = 500,
+    [BQ25895_USB_CDP] = 1500,
+    [BQ25895_USB_DCP] = 3250,
+    [BQ25895_MAX_CHARGE_DCP] = 1500,
+    [BQ25895_UNKNOWN] = 500,
+    [BQ25895_NON_STANDARD] = 1000,
+    [BQ25895_OTG] = 500
+};
+
+/**
+ * @brief Get the starting input current limit for a source type.
+ * @param[in] vbus_stat Detected input source type (VBUS_STAT)
+ * @retval Input current limit in mA
+ */
+uint16_t BQ25895_PlugInDefaultLimit(BQ25895_VBUS_STAT vbus_stat) {
+    if ((uint32_t)vbus_stat >= sizeof(BQ25895_PLUGIN_LIMIT_MA) / sizeof(BQ25895_PLUGIN_LIMIT_MA[0]))
+        return BQ25895_PLUGIN_LIMIT_MA[BQ25895_UNKNOWN];
+    return BQ25895_PLUGIN_LIMIT_MA[vbus_stat];
+}
+
+static void BQ25895_PlugIn_Ready(BQ25895_PLUGIN *pi, uint32_t now) {
+    pi->latency_ms = now - pi->plug_tick;
+    pi->dpm_tick = now;
+    pi->phase = BQ25895_PLUGIN_READY;
+}
+
+static void BQ25895_PlugIn_SetLimit(BQ25895_PLUGIN *pi, uint16_t current_ma, uint8_t run_ico) {
+    pi->iinlim_ma = current_ma;
+    pi->ico_pending = run_ico && (pi->config.run_ico == BQ25895_ENABLED);
+    pi->phase = BQ25895_PLUGIN_LIMIT;
+}
+
+/**
+ * @brief Handle one REG_0B status poll while waiting for the input or its type.
+ * @note A source type with a cached ICO result starts at that result and skips ICO.
+ */
+static void BQ25895_PlugIn_Status(BQ25895_PLUGIN *pi, uint8_t stat, uint32_t now) {
+    uint8_t pg = BQ25895_GET_FIELD(stat, PG_STAT);
+    uint16_t cached;
+
+    pi->vbus_stat = BQ25895_GET_FIELD(stat, VBUS_STAT);
+    if (pg == BQ25895_NO_POWER_GOOD) {
+        pi->phase = BQ25895_PLUGIN_WAIT_PG;
+        return;
+    }
+    if (pi->phase == BQ25895_PLUGIN_WAIT_PG) {
+        pi->plug_tick = now;
+        pi->ico_current_ma = 0;
+        pi->ico_done = 0;
+        pi->phase = BQ25895_PLUGIN_DETECT;
+    }
+    if (pi->vbus_stat == BQ25895_NO_INPUT && now - pi->plug_tick < pi->config.detect_timeout_ms)
+        return;
+
+    pi->detect_ms = now - pi->plug_tick;
+    cached = pi->ico_cache_ma[pi->vbus_stat];
+    if (cached != 0 && pi->config.run_ico == BQ25895_ENABLED)
+        BQ25895_PlugIn_SetLimit(pi, cached, 0);
+    else
+        BQ25895_PlugIn_SetLimit(pi, BQ25895_PlugInDefaultLimit(pi->vbus_stat), 1);
+}
+
+/**
+ * @brief Handle one REG_0B..REG_14 burst with the input current settled.
+ * @note ICO is run again when the source no longer looks like the one it was tuned for: VDPM persisting
+ * for retrigger_ms means the source got weaker, IDPM persisting on a cached limit that was not verified by
+ * ICO on this input means it may be stronger. Runs are at least ico_holdoff_ms apart.
+ */
+static void BQ25895_PlugIn_Watch(BQ25895_PLUGIN *pi, const uint8_t *regs, uint32_t now) {
+    uint8_t dpm = regs[BQ25895_REG_13 - BQ25895_REG_0B];
+    uint8_t vdpm = BQ25895_GET_FIELD(dpm, VDPM_STAT);
+    uint8_t idpm = BQ25895_GET_FIELD(dpm, IDPM_STAT);
+
+    if (BQ25895_GET_FIELD(regs[0], PG_STAT) == BQ25895_NO_POWER_GOOD) {
+        pi->vbus_stat = BQ25895_GET_FIELD(regs[0], VBUS_STAT);
+        pi->phase = BQ25895_PLUGIN_WAIT_PG;
+        return;
+    }
+    if (BQ25895_GET_FIELD(regs[0], VBUS_STAT) != pi->vbus_stat) {
+        /* Source type changed without losing power good (e.g. late DCP/HVDCP detection) */
+        pi->phase = BQ25895_PLUGIN_WAIT_PG;
+        BQ25895_PlugIn_Status(pi, regs[0], now);
+        return;
+    }
+    if (!vdpm && !(idpm && !pi->ico_done)) {
+        pi->dpm_tick = now;
+        return;
+    }
+    if (pi->config.run_ico != BQ25895_ENABLED || now - pi->dpm_tick < pi->config.retrigger_ms
+            || now - pi->ico_tick < pi->config.ico_holdoff_ms)
+        return;
+    pi->plug_tick = now;
+    pi->detect_ms = 0;
+    BQ25895_PlugIn_SetLimit(pi, BQ25895_PlugInDefaultLimit(pi->vbus_stat), 1);
+}
+
+/**
+ * @brief Start the plug-in handler.
+ * @param[out] *pi Plug-in handler instance.
+ * @param[in] *config Timing configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Enables the input current optimizer (ICO_EN) when run_ico is set.
+ * An input that is already present is handled as a fresh plug-in on the first step.
+ */
+HAL_StatusTypeDef BQ25895_PlugInStart(BQ25895_PLUGIN *pi, const BQ25895_PLUGIN_CONFIG *config) {
+    BQ25895_STATE state = BQ25895_ENABLED;
+    uint32_t now = HAL_GetTick();
+
+    *pi = (BQ25895_PLUGIN) { 0 };
+    pi->config = (config != NULL) ? *config : BQ25895_PLUGIN_DEFAULT_CONFIG;
+    pi->phase = BQ25895_PLUGIN_WAIT_PG;
+    pi->tick = now - pi->config.poll_interval_ms;
+    pi->ico_tick = now - pi->config.ico_holdoff_ms;
+
+    if (pi->config.run_ico == BQ25895_ENABLED)
+        return BQ25895_SetInputCurrentOptimizer(&state);
+    return HAL_OK;
+}
+
+/**
+ * @brief Advance the plug-in handler by one step.
+ * @param[in,out] *pi Plug-in handler instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. Power good is polled every poll_interval_ms.
+ * On its rising edge the handler waits for VBUS_STAT, updates IINLIM to the starting value for the source
+ * type, forces ICO and polls ICO_OPTIMIZED starting at ico_min_poll_ms and doubling up to ico_max_poll_ms.
+ * The time from power good to the settled input current is kept in latency_ms. ICO results are cached
+ * per source type and used as the starting IINLIM, without ICO, the next time that type is plugged in.
+ */
+HAL_StatusTypeDef BQ25895_PlugInStep(BQ25895_PLUGIN *pi) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_PLUGIN_ICO_BURST_LEN];
+    uint8_t temp;
+    uint32_t now = HAL_GetTick();
+
+    switch (pi->phase) {
+    case BQ25895_PLUGIN_LIMIT:
+        temp = BQ25895_ENCODE(pi->iinlim_ma, IINLIM);
+        status = BQ25895_UpdateBits(BQ25895_REG_00, BQ25895_IINLIM_MASK, &temp);
+        if (status != HAL_OK)
+            return status;
+        if (pi->ico_pending)
+            pi->phase = BQ25895_PLUGIN_ICO_START;
+        else
+            BQ25895_PlugIn_Ready(pi, now);
+        return status;
+    case BQ25895_PLUGIN_ICO_START:
+        temp = BQ25895_RESET << BQ25895_FORCE_ICO_BIT;
+        status = BQ25895_UpdateBits(BQ25895_REG_09, BQ25895_FORCE_ICO_MASK, &temp);
+        if (status != HAL_OK)
+            return status;
+        pi->phase = BQ25895_PLUGIN_ICO_POLL;
+        pi->poll_ms = pi->config.ico_min_poll_ms;
+        pi->ico_tick = now;
+        pi->tick = now;
+        return status;
+    case BQ25895_PLUGIN_ICO_POLL:
+        if (now - pi->tick < pi->poll_ms)
+            return HAL_OK;
+        status = BQ25895_ReadRegisters(BQ25895_REG_0B, regs, BQ25895_PLUGIN_ICO_BURST_LEN);
+        if (status != HAL_OK)
+            return status;
+        pi->tick = now;
+        if (BQ25895_GET_FIELD(regs[0], PG_STAT) == BQ25895_NO_POWER_GOOD) {
+            pi->phase = BQ25895_PLUGIN_WAIT_PG;
+        } else if (BQ25895_GET_FIELD(regs[BQ25895_REG_14 - BQ25895_REG_0B], ICO_OPTIMIZED)) {
+            pi->ico_current_ma = BQ25895_DECODE(regs[BQ25895_REG_13 - BQ25895_REG_0B], IDPM_LIM);
+            pi->ico_cache_ma[pi->vbus_stat] = pi->ico_current_ma;
+            pi->ico_done = 1;
+            BQ25895_PlugIn_Ready(pi, now);
+        } else if (now - pi->ico_tick >= pi->config.ico_timeout_ms) {
+            BQ25895_PlugIn_Ready(pi, now);
+        } else if (pi->poll_ms < pi->config.ico_max_poll_ms) {
+            pi->poll_ms <<= 1;
+            if (pi->poll_ms > pi->config.ico_max_poll_ms)
+                pi->poll_ms = pi->config.ico_max_poll_ms;
+        }
+        return status;
+    case BQ25895_PLUGIN_READY:
+        if (now - pi->tick < pi->config.poll_interval_ms)
+            return HAL_OK;
+        status = BQ25895_ReadRegisters(BQ25895_REG_0B, regs, BQ25895_PLUGIN_ICO_BURST_LEN);
+        if (status != HAL_OK)
+            return status;
+        pi->tick = now;
+        BQ25895_PlugIn_Watch(pi, regs, now);
+        return status;
+    default:
+        if (now - pi->tick < pi->config.poll_interval_ms)
+            return HAL_OK;
+        status = BQ25895_ReadRegister(BQ25895_REG_0B, &temp);
+        if (status != HAL_OK)
+            return status;
+        pi->tick = now;
+        BQ25895_PlugIn_Status(pi, temp, now);
+        return status;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+/**
+ *  @brief     Compile time battery chemistry profiles for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "main.h"
+#include "BQ25895_Profile.h"
+
+/* Reference profiles for a BQ25895_PROFILE_REF_MAH cell */
+BQ25895_PROFILE_DEFINE(BQ25895_PROFILE_LICOO2_4V2, BQ25895_CHEM_LICOO2_4V2, BQ25895_PROFILE_REF_MAH);
+BQ25895_PROFILE_DEFINE(BQ25895_PROFILE_NMC_4V1, BQ25895_CHEM_NMC_4V1, BQ25895_PROFILE_REF_MAH);
+BQ25895_PROFILE_DEFINE(BQ25895_PROFILE_LIHV_4V35, BQ25895_CHEM_LIHV_4V35, BQ25895_PROFILE_REF_MAH);
+BQ25895_PROFILE_DEFINE(BQ25895_PROFILE_LIHV_4V4, BQ25895_CHEM_LIHV_4V4, BQ25895_PROFILE_REF_MAH);
+BQ25895_PROFILE_DEFINE(BQ25895_PROFILE_LIPO_FAST_4V2, BQ25895_CHEM_LIPO_FAST_4V2, BQ25895_PROFILE_REF_MAH);
+
+/**
+ * @brief Write a profile: ICHG, IPRECHG, ITERM, VREG, BATLOWV, VRECHG, EN_TERM, WATCHDOG, EN_TIMER,
+ * CHG_TIMER and JEITA_ISET in one burst.
+ * @param[in] *profile Profile defined with BQ25895_PROFILE_DEFINE().
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note REG_04..REG_07 are written whole, EN_PUMPX is cleared and the STAT pin enabled.
+ */
+HAL_StatusTypeDef BQ25895_ProfileApply(const BQ25895_PROFILE *profile) {
+    uint8_t regs[BQ25895_PROFILE_LEN];
+    memcpy(regs, profile->regs, sizeof(regs));
+    return BQ25895_WriteRegisters(BQ25895_REG_04, regs, BQ25895_PROFILE_LEN);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,224 @@
+/**
+ *  @brief     Pump Express adapter voltage negotiation for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_PumpX.h"
+
+/* REG_0E (BATV) up to and including REG_13 (VDPM_STAT, IDPM_STAT) in one ADC burst */
+#define BQ25895_PUMPX_BURST_LEN     (BQ25895_REG_13 - BQ25895_REG_0E + 1)
+
+static const BQ25895_PUMPX_CONFIG BQ25895_PUMPX_DEFAULT_CONFIG = {
+    .max_mv = BQ25895_PUMPX_MAX_MV,
+    .min_rise_mv = BQ25895_PUMPX_MIN_RISE_MV,
+    .min_gain_pct = BQ25895_PUMPX_MIN_GAIN_PCT,
+    .max_retries = BQ25895_PUMPX_MAX_RETRIES,
+    .period_ms = BQ25895_PUMPX_PERIOD_MS,
+    .settle_ms = BQ25895_PUMPX_SETTLE_MS,
+    .pulse_timeout_ms = BQ25895_PUMPX_PULSE_TIMEOUT_MS,
+    .pulse_poll_ms = BQ25895_PUMPX_PULSE_POLL_MS,
+    .backoff_ms = BQ25895_PUMPX_BACKOFF_MS
+};
+
+static void BQ25895_PumpX_Request(BQ25895_PUMPX *px, uint8_t mask) {
+    px->step_vbus_mv = px->vbus_mv;
+    px->pending = mask;
+    px->request = mask;
+}
+
+/**
+ * @brief Ask for the next voltage step if there is room below max_mv, otherwise hold.
+ */
+static void BQ25895_PumpX_Climb(BQ25895_PUMPX *px, uint32_t now) {
+    if (px->vbus_mv + px->config.min_rise_mv <= px->config.max_mv) {
+        BQ25895_PumpX_Request(px, BQ25895_PUMPX_UP_MASK);
+        px->climbed = 1;
+    } else {
+        px->phase = BQ25895_PUMPX_HOLD;
+        px->hold_tick = now;
+    }
+}
+
+static void BQ25895_PumpX_Evaluate(BQ25895_PUMPX *px, const uint8_t *regs, uint32_t now) {
+    uint16_t vbat_mv = BQ25895_DECODE(regs[BQ25895_REG_0E - BQ25895_REG_0E], BATV);
+    uint16_t ichg_ma = BQ25895_DECODE(regs[BQ25895_REG_12 - BQ25895_REG_0E], ICHGR);
+    uint8_t vbus_gd = BQ25895_GET_FIELD(regs[BQ25895_REG_11 - BQ25895_REG_0E], VBUS_GD);
+    uint8_t vdpm = BQ25895_GET_FIELD(regs[BQ25895_REG_13 - BQ25895_REG_0E], VDPM_STAT);
+    uint8_t idpm = BQ25895_GET_FIELD(regs[BQ25895_REG_13 - BQ25895_REG_0E], IDPM_STAT);
+
+    px->vbus_mv = BQ25895_DECODE(regs[BQ25895_REG_11 - BQ25895_REG_0E], VBUSV);
+    px->power_mw = ((uint32_t)vbat_mv * ichg_ma) / 1000;
+
+    /* Adapter removed: the next adapter starts again from its plug-in voltage */
+    if (!vbus_gd || px->vbus_mv < BQ25895_PUMPX_MIN_VBUS_MV) {
+        px->phase = BQ25895_PUMPX_MEASURE;
+        px->level = 0;
+        px->best_level = 0;
+        px->best_power_mw = 0;
+        px->retries = 0;
+        px->climbed = 0;
+        px->backoff_ms = px->config.backoff_ms;
+        return;
+    }
+
+    switch (px->phase) {
+    case BQ25895_PUMPX_MEASURE:
+        px->best_power_mw = px->power_mw;
+        px->best_level = px->level;
+        if (vdpm && px->level > 0) {
+            BQ25895_PumpX_Request(px, BQ25895_PUMPX_DN_MASK);
+        } else if (vdpm || idpm) {
+            BQ25895_PumpX_Climb(px, now);
+        } else {
+            /* Charging is not input limited, a higher voltage only adds conversion loss */
+            px->phase = BQ25895_PUMPX_HOLD;
+            px->hold_tick = now;
+        }
+        return;
+    case BQ25895_PUMPX_SETTLE:
+        if (px->request == BQ25895_PUMPX_DN_MASK) {
+            if (px->level > 0)
+                px->level--;
+            px->phase = BQ25895_PUMPX_HOLD;
+            px->hold_tick = now;
+            return;
+        }
+        if (px->vbus_mv < px->step_vbus_mv + px->config.min_rise_mv) {
+            /* The adapter did not answer the pulse sequence */
+            if (++px->retries >= px->config.max_retries) {
+                px->phase = BQ25895_PUMPX_HOLD;
+                px->hold_tick = now;
+            } else {
+                BQ25895_PumpX_Request(px, BQ25895_PUMPX_UP_MASK);
+            }
+            return;
+        }
+        px->level++;
+        px->retries = 0;
+        if (!vdpm && px->power_mw * 100 >= px->best_power_mw * (100 + px->config.min_gain_pct)) {
+            px->best_power_mw = px->power_mw;
+            px->best_level = px->level;
+            if (idpm) {
+                BQ25895_PumpX_Climb(px, now);
+            } else {
+                /* No longer current limited, the next step cannot add power */
+                px->phase = BQ25895_PUMPX_HOLD;
+                px->hold_tick = now;
+            }
+        } else {
+            /* Adapter sags at this voltage or charging got no faster: go back to the best level */
+            BQ25895_PumpX_Request(px, BQ25895_PUMPX_DN_MASK);
+        }
+        return;
+    default:
+        if (vdpm && px->level > 0) {
+            BQ25895_PumpX_Request(px, BQ25895_PUMPX_DN_MASK);
+        } else if ((vdpm || idpm) && !px->climbed) {
+            /* Held without an input limit, one showed up since: measure and climb */
+            px->phase = BQ25895_PUMPX_MEASURE;
+        } else if (px->retries >= px->config.max_retries && now - px->hold_tick >= px->backoff_ms) {
+            px->retries = 0;
+            if (px->backoff_ms < 0x80000000)
+                px->backoff_ms <<= 1;
+            px->phase = BQ25895_PUMPX_MEASURE;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Start adapter voltage negotiation.
+ * @param[out] *px Sequencer instance.
+ * @param[in] *config Sequencer configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Enables current pulse control (EN_PUMPX) and continuous ADC conversion. Keep relative
+ * VINDPM (FORCE_VINDPM = 0) so the threshold follows the new adapter voltage.
+ */
+HAL_StatusTypeDef BQ25895_PumpXStart(BQ25895_PUMPX *px, const BQ25895_PUMPX_CONFIG *config) {
+    HAL_StatusTypeDef status;
+    BQ25895_CONV_RATE rate = BQ25895_ADC_CONTINUOUS;
+    BQ25895_STATE state = BQ25895_ENABLED;
+
+    *px = (BQ25895_PUMPX) { 0 };
+    px->config = (config != NULL) ? *config : BQ25895_PUMPX_DEFAULT_CONFIG;
+    px->phase = BQ25895_PUMPX_MEASURE;
+    px->backoff_ms = px->config.backoff_ms;
+    px->tick = HAL_GetTick();
+
+    status = BQ25895_SetADCconversionMode(&rate);
+    if (status != HAL_OK)
+        return status;
+    return BQ25895_SetCurrentPulseMode(&state);
+}
+
+/**
+ * @brief Advance adapter voltage negotiation by one step.
+ * @param[in,out] *px Sequencer instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. The adapter voltage is only stepped up while
+ * charging is input limited (IDPM_STAT, or VDPM_STAT at the plug-in voltage), and only while every accepted
+ * step raises charge power (VBAT x ICHGR) by at least min_gain_pct and VINDPM is not hit. Without an input
+ * limit the voltage is held. A step that does not pay off, or an adapter that sags into VINDPM, is undone
+ * with one step down.
+ * An adapter that does not answer max_retries requests is left alone for backoff_ms, doubled each time.
+ * Step requests only touch PUMPX_UP/PUMPX_DN, the end of a pulse sequence is polled every pulse_poll_ms.
+ */
+HAL_StatusTypeDef BQ25895_PumpXStep(BQ25895_PUMPX *px) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_PUMPX_BURST_LEN];
+    uint8_t temp;
+    uint32_t now = HAL_GetTick();
+
+    if (px->pending) {
+        status = BQ25895_UpdateBits(BQ25895_REG_09, BQ25895_PUMPX_UP_MASK | BQ25895_PUMPX_DN_MASK, &px->pending);
+        if (status == HAL_OK) {
+            px->pending = 0;
+            px->phase = BQ25895_PUMPX_PULSE;
+            px->tick = now;
+            px->poll_tick = now;
+        }
+        return status;
+    }
+
+    switch (px->phase) {
+    case BQ25895_PUMPX_PULSE:
+        /* PUMPX_UP/PUMPX_DN return to 0 once the pulse sequence is done */
+        if (now - px->tick < px->config.pulse_timeout_ms) {
+            if (now - px->poll_tick < px->config.pulse_poll_ms)
+                return HAL_OK;
+            px->poll_tick = now;
+            status = BQ25895_ReadRegister(BQ25895_REG_09, &temp);
+            if (status != HAL_OK || (temp & (BQ25895_PUMPX_UP_MASK | BQ25895_PUMPX_DN_MASK)))
+                return status;
+        }
+        px->phase = BQ25895_PUMPX_SETTLE;
+        px->tick = now;
+        return HAL_OK;
+    case BQ25895_PUMPX_SETTLE:
+        if (now - px->tick < px->config.settle_ms)
+            return HAL_OK;
+        break;
+    default:
+        if (now - px->tick < px->config.period_ms)
+            return HAL_OK;
+        break;
+    }
+
+    px->tick = now;
+    status = BQ25895_ReadRegisters(BQ25895_REG_0E, regs, BQ25895_PUMPX_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    BQ25895_PumpX_Evaluate(px, regs, now);
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,148 @@
+/**
+ *  @brief     Coulomb counting and OCV fusion state-of-charge estimator for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_SoC.h"
+
+/* Rested open-circuit voltage of a LiCoO2/graphite cell at 0%, 10%, ... 100% state of charge */
+static const uint16_t BQ25895_SOC_OCV_MV[] = {
+    3300, 3600, 3690, 3740, 3770, 3810, 3870, 3940, 4020, 4100, 4190
+};
+#define BQ25895_SOC_OCV_POINTS      (sizeof(BQ25895_SOC_OCV_MV) / sizeof(BQ25895_SOC_OCV_MV[0]))
+#define BQ25895_SOC_OCV_STEP        (1000 / (BQ25895_SOC_OCV_POINTS - 1))
+
+/**
+ * @brief State of charge from a rested battery voltage.
+ * @param[in] voltage_mv Open-circuit battery voltage in mV, e.g. from BQ25895_GetBatteryVoltage()
+ * @retval State of charge in 0.1% (0 - 1000)
+ */
+uint16_t BQ25895_SoCFromOCV(uint16_t voltage_mv) {
+    uint8_t i;
+    if (voltage_mv <= BQ25895_SOC_OCV_MV[0])
+        return 0;
+    for (i = 1; i < BQ25895_SOC_OCV_POINTS; i++) {
+        if (voltage_mv < BQ25895_SOC_OCV_MV[i])
+            return (i - 1) * BQ25895_SOC_OCV_STEP
+                    + ((uint32_t)BQ25895_SOC_OCV_STEP * (voltage_mv - BQ25895_SOC_OCV_MV[i - 1]))
+                    / (BQ25895_SOC_OCV_MV[i] - BQ25895_SOC_OCV_MV[i - 1]);
+    }
+    return 1000;
+}
+
+/**
+ * @brief Integrate a constant current over a time step.
+ * @param[in,out] *residue_mams Sub mAs remainder carried between calls, in mAms, start at 0.
+ * @param[in] current_ma Current in mA, positive while charging.
+ * @param[in] dt_ms Time step in ms, any length up to the full tick range.
+ * @retval Whole mAs moved during the step, saturated to the int32_t range
+ * @note Whole seconds and the millisecond remainder are integrated separately, so no intermediate
+ * overflows and no 64-bit division is needed.
+ */
+int32_t BQ25895_SoCIntegrate(int32_t *residue_mams, int32_t current_ma, uint32_t dt_ms) {
+    int64_t mas = (int64_t)current_ma * (dt_ms / 1000);
+    int32_t part = *residue_mams + current_ma * (int32_t)(dt_ms % 1000);
+
+    mas += part / 1000;
+    *residue_mams = part % 1000;
+    if (mas > INT32_MAX)
+        return INT32_MAX;
+    if (mas < INT32_MIN)
+        return INT32_MIN;
+    return (int32_t)mas;
+}
+
+/**
+ * @brief Initialise the state-of-charge estimator.
+ * @param[out] *soc Estimator instance.
+ * @param[in] *config Battery capacity and filter settings.
+ * @note The estimate is seeded from the OCV curve on the first BQ25895_SoCUpdate().
+ */
+void BQ25895_SoCInit(BQ25895_SOC *soc, const BQ25895_SOC_CONFIG *config) {
+    *soc = (BQ25895_SOC) { 0 };
+    soc->config = *config;
+    if (soc->config.rest_current_ma == 0)
+        soc->config.rest_current_ma = BQ25895_SOC_REST_CURRENT_MA;
+    if (soc->config.rest_time_ms == 0)
+        soc->config.rest_time_ms = BQ25895_SOC_REST_TIME_MS;
+    if (soc->config.ocv_gain_q16 == 0)
+        soc->config.ocv_gain_q16 = BQ25895_SOC_OCV_GAIN_Q16;
+    soc->capacity_mas = (int32_t)config->capacity_mah * 3600;
+    soc->mas_per_permille = soc->capacity_mas / 1000;
+}
+
+/**
+ * @brief Feed one battery sample into the estimator.
+ * @param[in,out] *soc Estimator instance.
+ * @param[in] current_ma Battery current in mA, positive while charging (ICHGR). Pass a negative value
+ * for a known discharge current; ICHGR itself reads 0 while discharging.
+ * @param[in] voltage_mv Battery voltage in mV (BATV)
+ * @param[in] now_ms Sample time in ms, e.g. HAL_GetTick()
+ * @note Pure arithmetic, no bus access. Meant to be called at about 1Hz with values from an ADC burst
+ * the application already performs. Charge is integrated every call; once the current has stayed within
+ * rest_current_ma for rest_time_ms the estimate is pulled towards the OCV curve with gain ocv_gain_q16.
+ * Gaps of any length are integrated without overflow. Two 64-bit multiplies and no 64-bit division are
+ * used, keeping the cost negligible on Cortex-M0+.
+ */
+void BQ25895_SoCUpdate(BQ25895_SOC *soc, int16_t current_ma, uint16_t voltage_mv, uint32_t now_ms) {
+    uint32_t dt_ms = now_ms - soc->last_ms;
+    int64_t charge_mas;
+    int32_t target_mas;
+    int32_t delta;
+
+    soc->last_ms = now_ms;
+    if (!soc->valid) {
+        soc->charge_mas = soc->mas_per_permille * BQ25895_SoCFromOCV(voltage_mv);
+        soc->valid = 1;
+        return;
+    }
+
+    charge_mas = (int64_t)soc->charge_mas + BQ25895_SoCIntegrate(&soc->residue_mams, current_ma, dt_ms);
+    if (charge_mas < 0)
+        charge_mas = 0;
+    if (charge_mas > soc->capacity_mas)
+        charge_mas = soc->capacity_mas;
+    soc->charge_mas = (int32_t)charge_mas;
+
+    if (current_ma <= (int16_t)soc->config.rest_current_ma && current_ma >= -(int16_t)soc->config.rest_current_ma) {
+        if (dt_ms >= soc->config.rest_time_ms - soc->rest_ms)
+            soc->rest_ms = soc->config.rest_time_ms;
+        else
+            soc->rest_ms += dt_ms;
+    } else {
+        soc->rest_ms = 0;
+    }
+
+    if (soc->rest_ms >= soc->config.rest_time_ms) {
+        target_mas = soc->mas_per_permille * BQ25895_SoCFromOCV(voltage_mv);
+        delta = ((int64_t)(target_mas - soc->charge_mas) * soc->config.ocv_gain_q16) >> 16;
+        soc->charge_mas += delta;
+    }
+
+    if (soc->charge_mas < 0)
+        soc->charge_mas = 0;
+    if (soc->charge_mas > soc->mas_per_permille * 1000)
+        soc->charge_mas = soc->mas_per_permille * 1000;
+}
+
+/**
+ * @brief Get the current state-of-charge estimate.
+ * @param[in] *soc Estimator instance.
+ * @retval State of charge in 0.1% (0 - 1000)
+ */
+uint16_t BQ25895_SoCGet(const BQ25895_SOC *soc) {
+    if (soc->mas_per_permille == 0)
+        return 0;
+    return soc->charge_mas / soc->mas_per_permille;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+/**
+ *  @brief     State-of-health tracking from charge cycle fingerprints for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_SoH.h"
+#include "BQ25895_SoC.h"
+
+static void BQ25895_SoH_Finish(BQ25895_SOH *soh, BQ25895_SOH_END end) {
+    BQ25895_SOH_CYCLE *cycle = &soh->cycle;
+    uint16_t start_soc = BQ25895_SoCFromOCV(cycle->start_mv);
+    uint32_t soh_permille;
+
+    cycle->end = end;
+    cycle->end_ma = soh->last_ma;
+    cycle->charge_mah = soh->charge_mas / 3600;
+    cycle->capacity_mah = 0;
+    if (end == BQ25895_SOH_TERMINATED && start_soc <= BQ25895_SOH_MAX_START_SOC)
+        cycle->capacity_mah = ((uint32_t)cycle->charge_mah * 1000) / (1000 - start_soc);
+
+    if (cycle->capacity_mah != 0 && soh->config.design_capacity_mah != 0) {
+        soh_permille = ((uint32_t)cycle->capacity_mah * 1000) / soh->config.design_capacity_mah;
+        if (soh->soh_permille == 0)
+            soh->soh_permille = soh_permille;
+        else
+            soh->soh_permille += (((int32_t)soh_permille - soh->soh_permille) * BQ25895_SOH_WEIGHT_Q8) / 256;
+    }
+
+    soh->ring[soh->head] = *cycle;
+    soh->head = (soh->head + 1) % BQ25895_SOH_HISTORY;
+    if (soh->count < BQ25895_SOH_HISTORY)
+        soh->count++;
+    soh->active = 0;
+}
+
+/**
+ * @brief Initialise the state-of-health tracker.
+ * @param[out] *soh Tracker instance.
+ * @param[in] *config Design capacity and charge voltage.
+ */
+void BQ25895_SoHInit(BQ25895_SOH *soh, const BQ25895_SOH_CONFIG *config) {
+    *soh = (BQ25895_SOH) { 0 };
+    soh->config = *config;
+}
+
+/**
+ * @brief Feed one charger sample into the tracker.
+ * @param[in,out] *soh Tracker instance.
+ * @param[in] state Charging status (CHRG_STAT), e.g. from BQ25895_GetChargingStatus()
+ * @param[in] current_ma Charge current in mA (ICHGR)
+ * @param[in] voltage_mv Battery voltage in mV (BATV)
+ * @param[in] now_ms Sample time in ms, e.g. HAL_GetTick()
+ * @note O(1), no bus access. A cycle starts when CHRG_STAT enters pre-charge or fast charge and ends on
+ * termination done or when charging stops. Time with BATV within BQ25895_SOH_CV_MARGIN_MV of VREG counts
+ * as CV. When a terminated cycle started from a rested voltage below BQ25895_SOH_MAX_START_SOC, the delivered
+ * charge is scaled to a full capacity estimate that feeds the state of health.
+ */
+void BQ25895_SoHUpdate(BQ25895_SOH *soh, BQ25895_CHRG_STAT state, uint16_t current_ma, uint16_t voltage_mv,
+        uint32_t now_ms) {
+    uint8_t charging = (state == BQ25895_PRE_CHARGE) || (state == BQ25895_FAST_CHARGE);
+    uint32_t dt_ms = now_ms - soh->last_ms;
+    uint32_t dt_s;
+    int64_t charge_mas;
+
+    if (!soh->active) {
+        if (!charging) {
+            soh->idle_mv = voltage_mv;
+        } else {
+            soh->cycle = (BQ25895_SOH_CYCLE) { 0 };
+            soh->cycle.start_mv = (soh->idle_mv != 0) ? soh->idle_mv : voltage_mv;
+            soh->charge_mas = 0;
+            soh->residue_mams = 0;
+            soh->active = 1;
+        }
+        soh->last_ma = current_ma;
+        soh->last_ms = now_ms;
+        return;
+    }
+
+    charge_mas = (int64_t)soh->charge_mas + BQ25895_SoCIntegrate(&soh->residue_mams, soh->last_ma, dt_ms);
+    soh->charge_mas = (charge_mas > UINT32_MAX) ? UINT32_MAX : (uint32_t)charge_mas;
+    dt_s = (dt_ms + 500) / 1000;
+    if (state == BQ25895_FAST_CHARGE && voltage_mv + BQ25895_SOH_CV_MARGIN_MV >= soh->config.vreg_mv)
+        soh->cycle.cv_s += dt_s;
+    else if (charging)
+        soh->cycle.cc_s += dt_s;
+
+    soh->last_ma = current_ma;
+    soh->last_ms = now_ms;
+
+    if (state == BQ25895_CHARGE_TERMINATION)
+        BQ25895_SoH_Finish(soh, BQ25895_SOH_TERMINATED);
+    else if (!charging)
+        BQ25895_SoH_Finish(soh, BQ25895_SOH_ABORTED);
+}
+
+/**
+ * @brief Get a recorded cycle summary.
+ * @param[in] *soh Tracker instance.
+ * @param[in] age 0 for the most recent cycle, 1 for the one before, ...
+ * @retval Pointer to the summary or NULL if fewer cycles were recorded
+ */
+const BQ25895_SOH_CYCLE *BQ25895_SoHGetCycle(const BQ25895_SOH *soh, uint8_t age) {
+    if (age >= soh->count)
+        return NULL;
+    return &soh->ring[(soh->head + BQ25895_SOH_HISTORY - 1 - age) % BQ25895_SOH_HISTORY];
+}
+
+/**
+ * @brief Get the smoothed state of health.
+ * @param[in] *soh Tracker instance.
+ * @retval Estimated capacity relative to design capacity in 0.1%, 0 until a usable cycle was recorded
+ */
+uint16_t BQ25895_SoHGet(const BQ25895_SOH *soh) {
+    return soh->soh_permille;
+}
+
+/**
+ * @brief Get the capacity trend over the recorded cycles.
+ * @param[in] *soh Tracker instance.
+ * @retval Capacity change from the oldest to the newest usable cycle in the ring, in 0.1% of design capacity
+ * per cycle. Negative means the pack is degrading. 0 with fewer than two usable cycles.
+ */
+int16_t BQ25895_SoHGetTrend(const BQ25895_SOH *soh) {
+    const BQ25895_SOH_CYCLE *newest = NULL;
+    const BQ25895_SOH_CYCLE *oldest = NULL;
+    const BQ25895_SOH_CYCLE *cycle;
+    uint8_t newest_age = 0;
+    uint8_t oldest_age = 0;
+    uint8_t age;
+
+    for (age = 0; age < soh->count; age++) {
+        cycle = BQ25895_SoHGetCycle(soh, age);
+        if (cycle->capacity_mah == 0)
+            continue;
+        if (newest == NULL) {
+            newest = cycle;
+            newest_age = age;
+        }
+        oldest = cycle;
+        oldest_age = age;
+    }
+    if (newest == NULL || oldest_age == newest_age || soh->config.design_capacity_mah == 0)
+        return 0;
+    return (((int32_t)newest->capacity_mah - oldest->capacity_mah) * 1000)
+            / ((int32_t)soh->config.design_capacity_mah * (oldest_age - newest_age));
+}
+
+#ifdef __cplusplus
+}
+#endif
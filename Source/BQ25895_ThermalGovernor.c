@@ -0,0 +1,178 @@
+/**
+ *  @brief     Thermal-aware charge current governor for the BQ25895 charge controller IC.
+ *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895
+ *  @date      May 2023
+ *  @copyright GPL-3.0 license.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "BQ25895_ThermalGovernor.h"
+
+/* REG_0E (THERM_STAT) up to and including REG_10 (TSPCT) in one burst, REG_0C is left to its owner */
+#define BQ25895_TG_BURST_LEN        (BQ25895_REG_10 - BQ25895_REG_0E + 1)
+/* Longest hold after a TREG back off, in periods */
+#define BQ25895_TG_HOLD_MAX         64
+
+static const BQ25895_TG_CONFIG BQ25895_TG_DEFAULT_CONFIG = {
+    .ichg_max_ma = BQ25895_TG_ICHG_MAX_MA,
+    .ichg_min_ma = BQ25895_TG_ICHG_MIN_MA,
+    .derate_start_pct = BQ25895_TG_DERATE_START_PCT,
+    .derate_end_pct = BQ25895_TG_DERATE_END_PCT,
+    .treg_backoff_q8 = BQ25895_TG_TREG_BACKOFF_Q8,
+    .recover_step_ma = BQ25895_TG_RECOVER_STEP_MA,
+    .slew_down_ma = BQ25895_TG_SLEW_DOWN_MA,
+    .deadband_ma = BQ25895_TG_DEADBAND_MA,
+    .period_ms = BQ25895_TG_PERIOD_MS
+};
+
+/**
+ * @brief Charge current allowed by the TS reading alone, linear between derate_start_pct and derate_end_pct.
+ */
+static uint16_t BQ25895_TG_DerateCurve(const BQ25895_TG_CONFIG *cfg, uint16_t ts_pct) {
+    uint32_t span = cfg->derate_start_pct - cfg->derate_end_pct;
+    if (ts_pct >= cfg->derate_start_pct)
+        return cfg->ichg_max_ma;
+    if (ts_pct <= cfg->derate_end_pct || span == 0)
+        return cfg->ichg_min_ma;
+    return cfg->ichg_min_ma
+            + ((uint32_t)(cfg->ichg_max_ma - cfg->ichg_min_ma) * (ts_pct - cfg->derate_end_pct)) / span;
+}
+
+/**
+ * @brief Get the charge current the governor is currently aiming for.
+ * @param[in] *tg Governor instance.
+ * @retval Charge current in mA, before slew limiting and rounding to the ICHG step.
+ */
+uint16_t BQ25895_ThermalGovernorTarget(const BQ25895_THERMAL_GOVERNOR *tg) {
+    uint16_t target = BQ25895_TG_DerateCurve(&tg->config, tg->ts_pct);
+    if (tg->ntc_fault != BQ25895_NTC_NORMAL)
+        target = tg->config.ichg_min_ma;
+    return (target < tg->ceiling_ma) ? target : tg->ceiling_ma;
+}
+
+static void BQ25895_TG_Control(BQ25895_THERMAL_GOVERNOR *tg) {
+    const BQ25895_TG_CONFIG *cfg = &tg->config;
+    uint8_t treg = (tg->therm_stat == BQ25895_IN_THERMAL_REGULATION);
+    uint32_t target;
+    uint32_t change;
+
+    /*
+     * AIMD on the die temperature loop: back off fast in TREG, creep back up outside it. Every TREG hit
+     * doubles the periods the ceiling is held before it creeps up again, so it settles under the TREG
+     * point instead of probing it every few seconds.
+     */
+    if (treg) {
+        tg->ceiling_ma = ((uint32_t)tg->level_ma * cfg->treg_backoff_q8) >> 8;
+        if (tg->ceiling_ma < cfg->ichg_min_ma)
+            tg->ceiling_ma = cfg->ichg_min_ma;
+        tg->hold_len = (tg->hold_len == 0) ? 1 : tg->hold_len << 1;
+        if (tg->hold_len > BQ25895_TG_HOLD_MAX)
+            tg->hold_len = BQ25895_TG_HOLD_MAX;
+        tg->hold = tg->hold_len;
+    } else if (tg->hold != 0) {
+        tg->hold--;
+    } else if (tg->ceiling_ma < cfg->ichg_max_ma) {
+        tg->ceiling_ma += cfg->recover_step_ma;
+        if (tg->ceiling_ma >= cfg->ichg_max_ma) {
+            tg->ceiling_ma = cfg->ichg_max_ma;
+            tg->hold_len = 0;
+        }
+    }
+
+    target = BQ25895_ThermalGovernorTarget(tg);
+    if (!treg && target + cfg->slew_down_ma < tg->level_ma)
+        target = tg->level_ma - cfg->slew_down_ma;
+    if (target > tg->level_ma + cfg->recover_step_ma)
+        target = tg->level_ma + cfg->recover_step_ma;
+    tg->level_ma = target;
+
+    /* Changes within the deadband cost a write for nothing, TREG back off and the end stops are always written */
+    target -= target % BQ25895_ICHG_LSB;
+    change = (target > tg->ichg_ma) ? target - tg->ichg_ma : tg->ichg_ma - target;
+    if (change == 0 || (change < cfg->deadband_ma && !treg && target > cfg->ichg_min_ma
+            && target < cfg->ichg_max_ma))
+        return;
+    tg->ichg_ma = target;
+    tg->pending = 1;
+}
+
+/**
+ * @brief Start the thermal governor.
+ * @param[out] *tg Governor instance.
+ * @param[in] *config Governor configuration or NULL for the defaults.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Blocking. Switches the ADC to continuous conversion so TSPCT stays fresh, and takes the
+ * present ICHG setting as the starting point.
+ */
+HAL_StatusTypeDef BQ25895_ThermalGovernorStart(BQ25895_THERMAL_GOVERNOR *tg, const BQ25895_TG_CONFIG *config) {
+    HAL_StatusTypeDef status;
+    uint8_t temp;
+    BQ25895_CONV_RATE rate = BQ25895_ADC_CONTINUOUS;
+    uint32_t now = HAL_GetTick();
+
+    *tg = (BQ25895_THERMAL_GOVERNOR) { 0 };
+    tg->config = (config != NULL) ? *config : BQ25895_TG_DEFAULT_CONFIG;
+    tg->ceiling_ma = tg->config.ichg_max_ma;
+    tg->ts_pct = tg->config.derate_start_pct;
+    tg->tick = now - tg->config.period_ms;
+
+    status = BQ25895_SetADCconversionMode(&rate);
+    if (status != HAL_OK)
+        return status;
+    status = BQ25895_ReadRegister(BQ25895_REG_04, &temp);
+    if (status != HAL_OK)
+        return status;
+    tg->ichg_ma = BQ25895_DECODE(temp, ICHG);
+    tg->level_ma = tg->ichg_ma;
+    return status;
+}
+
+/**
+ * @brief Advance the thermal governor by one step.
+ * @param[in,out] *tg Governor instance.
+ * @retval HAL_StatusTypeDef variable describing if it was successful or not
+ * @note Non-blocking, at most one register access per call. THERM_STAT and TSPCT are read in one burst
+ * every period_ms; a changed ICHG is written on the next call as a field update, leaving EN_PUMPX to its owner.
+ * @note REG_0C is not read since that clears its latched faults for every other consumer. NTC_FAULT is
+ * taken from the register cache, kept current by whoever reads REG_0C (charge manager, fault log); without
+ * a cache only the TS derating curve applies.
+ */
+HAL_StatusTypeDef BQ25895_ThermalGovernorStep(BQ25895_THERMAL_GOVERNOR *tg) {
+    HAL_StatusTypeDef status;
+    uint8_t regs[BQ25895_TG_BURST_LEN];
+    uint32_t now = HAL_GetTick();
+    uint16_t ts_pct;
+    uint8_t temp;
+
+    if (tg->pending) {
+        temp = BQ25895_ENCODE(tg->ichg_ma, ICHG);
+        status = BQ25895_UpdateBits(BQ25895_REG_04, BQ25895_ICHG_MASK, &temp);
+        if (status == HAL_OK)
+            tg->pending = 0;
+        return status;
+    }
+    if (now - tg->tick < tg->config.period_ms)
+        return HAL_OK;
+    tg->tick = now;
+
+    status = BQ25895_ReadRegisters(BQ25895_REG_0E, regs, BQ25895_TG_BURST_LEN);
+    if (status != HAL_OK)
+        return status;
+    if (BQ25895_GetCachedRegister(BQ25895_REG_0C, &temp) == HAL_OK)
+        tg->ntc_fault = BQ25895_GET_FIELD(temp, FAULT_NTC);
+    tg->therm_stat = BQ25895_GET_FIELD(regs[BQ25895_REG_0E - BQ25895_REG_0E], THERM_STAT);
+    ts_pct = BQ25895_DECODE(regs[BQ25895_REG_10 - BQ25895_REG_0E], TSPCT);
+    /* One TSPCT step of hysteresis: hotter readings count at once, cooler ones only past the next step */
+    if (ts_pct < tg->ts_pct || ts_pct > tg->ts_pct + BQ25895_TSPCT_LSB)
+        tg->ts_pct = ts_pct;
+    BQ25895_TG_Control(tg);
+    return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Compiles a readable charger profile into a BQ25895_Config.h blob for BQ25895_ConfigApply().
+
+Field names, masks and scaling are read from Include/BQ25895_REG.h. One "FIELD = value" per line, '#'
+starts a comment. Fields with a BASE/LSB take physical values (mA, mV, a unit suffix is allowed), all
+other fields take the raw code. "REG_xx = 0x.." sets a whole register. Only REG_00..REG_0A can be set,
+self clearing command bits are refused: as fields, and as set bits of a whole register, whose command
+bits are left out of the write mask.
+
+    # SKU A, 3000mAh LiHV pack
+    IINLIM = 2000mA
+    ICHG = 1536mA
+    VREG = 4352mV
+    BATLOWV = 1
+    ICO_EN = 1
+
+Usage: python3 Tools/config_blob.py sku_a.cfg -o sku_a.bin
+       python3 Tools/config_blob.py sku_a.cfg --c BQ25895_SKU_A > sku_a_config.c
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = b"BQCF"
+VERSION = 1
+LAST_REG = 0x0A
+COMMANDS = {"CONV_START", "FORCE_DPDM", "WDT_RESET", "FORCE_ICO", "PUMPX_UP", "PUMPX_DN", "RESET", "BATFET_DIS"}
+REG_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Include", "BQ25895_REG.h")
+
+
+def load_fields(path):
+    """Returns {field: {reg, MASK, BIT, BASE?, LSB?}} from the register map header."""
+    fields = {}
+    reg = None
+    for line in open(path):
+        m = re.match(r"#define\s+BQ25895_REG_([0-9A-F]{2})\s+(0x[0-9A-Fa-f]+)", line)
+        if m:
+            reg = int(m.group(2), 16)
+            continue
+        m = re.match(r"#define\s+BQ25895_(\w+)_(MASK|BIT|BASE|LSB)\s+(\w+)", line)
+        if m and reg is not None:
+            fields.setdefault(m.group(1), {"reg": reg})[m.group(2)] = int(m.group(3), 0)
+    return fields
+
+
+def command_masks(fields):
+    """Returns {reg: mask} of the command bits per register."""
+    masks = {}
+    for name in COMMANDS:
+        if name in fields:
+            masks[fields[name]["reg"]] = masks.get(fields[name]["reg"], 0) | fields[name]["MASK"]
+    return masks
+
+
+def parse_value(text):
+    m = re.fullmatch(r"(0x[0-9A-Fa-f]+|\d+)\s*(mA|mV|mOhm|%)?", text.strip())
+    if not m:
+        raise ValueError("bad value '%s'" % text.strip())
+    return int(m.group(1), 0)
+
+
+def compile_profile(lines, fields):
+    mask = [0] * (LAST_REG + 1)
+    value = [0] * (LAST_REG + 1)
+    commands = command_masks(fields)
+    for number, line in enumerate(lines, 1):
+        line = line.split("#", 1)[0].strip()
+        if not line:
+            continue
+        try:
+            name, text = (part.strip() for part in line.split("=", 1))
+            name = name.upper()
+            v = parse_value(text)
+            m = re.fullmatch(r"REG_([0-9A-F]{2})", name)
+            if m:
+                reg, code = int(m.group(1), 16), v
+                field_mask = 0xFF & ~commands.get(reg, 0)
+                if code > 0xFF:
+                    raise ValueError("register value out of range")
+                if code & ~field_mask:
+                    raise ValueError("REG_%02X = 0x%02X sets command bits 0x%02X" % (reg, code, code & ~field_mask))
+            else:
+                if name not in fields:
+                    raise ValueError("unknown field %s" % name)
+                if name in COMMANDS:
+                    raise ValueError("%s is a command bit, not configuration" % name)
+                f = fields[name]
+                reg, field_mask = f["reg"], f["MASK"]
+                top = field_mask >> f["BIT"]
+                code = v
+                if "LSB" in f:
+                    if (v - f["BASE"]) % f["LSB"]:
+                        raise ValueError("%s: %d is not a multiple of %d above %d" % (name, v, f["LSB"], f["BASE"]))
+                    code = (v - f["BASE"]) // f["LSB"]
+                if code < 0 or code > top:
+                    raise ValueError("%s: %d out of range" % (name, v))
+                code <<= f["BIT"]
+            if reg > LAST_REG:
+                raise ValueError("REG_%02X cannot be configured" % reg)
+            if mask[reg] & field_mask:
+                raise ValueError("bits of REG_%02X set twice" % reg)
+        except ValueError as e:
+            raise SystemExit("line %d: %s" % (number, e))
+        mask[reg] |= field_mask
+        value[reg] = (value[reg] & ~field_mask) | (code & field_mask)
+
+    used = [reg for reg in range(LAST_REG + 1) if mask[reg]]
+    if not used:
+        raise SystemExit("empty profile")
+    first, last = used[0], used[-1]
+    body = MAGIC + struct.pack("<BBBB", VERSION, first, last - first + 1, 0)
+    body += bytes(mask[first:last + 1]) + bytes(value[first:last + 1])
+    return body + struct.pack("<I", zlib.crc32(body) & 0xFFFFFFFF)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip())
+    parser.add_argument("profile")
+    parser.add_argument("-o", "--output", help="binary blob to write")
+    parser.add_argument("--c", metavar="NAME", help="print a C array called NAME instead")
+    args = parser.parse_args()
+
+    blob = compile_profile(open(args.profile).readlines(), load_fields(REG_H))
+    if args.c:
+        print("/* Generated by Tools/config_blob.py from %s, do not edit. */" % os.path.basename(args.profile))
+        print('#include "BQ25895_Config.h"')
+        print()
+        print("const uint8_t %s[%d] = {" % (args.c, len(blob)))
+        for i in range(0, len(blob), 12):
+            print("    " + ", ".join("0x%02X" % b for b in blob[i:i + 12]) + ",")
+        print("};")
+    elif args.output:
+        with open(args.output, "wb") as out:
+            out.write(blob)
+    else:
+        sys.stdout.buffer.write(blob)
+
+
+if __name__ == "__main__":
+    main()
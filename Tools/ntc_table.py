@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""
+Generates Source/BQ25895_NTCTable.c, the TS percentage lookup tables used by BQ25895_NTC.c.
+
+The TS pin sits on a REGN -> RT1 -> TS -> (RT2 || NTC) -> GND divider, so TSPCT = Rlow / (RT1 + Rlow)
+with Rlow = RT2 || Rntc. Rntc follows the Beta model around R25.
+
+Usage: python3 Tools/ntc_table.py > Source/BQ25895_NTCTable.c
+"""
+
+import math
+
+T_MIN_C = -40
+T_MAX_C = 100
+T_STEP_C = 5
+
+# name, R25 (ohm), Beta (K), RT1 (ohm), RT2 (ohm)
+PROFILES = [
+    ("BQ25895_NTC_103AT", 10000, 3435, 5230, 30100),
+    ("BQ25895_NTC_NCP15XH103", 10000, 3380, 5230, 30100),
+    ("BQ25895_NTC_100K_B4250", 100000, 4250, 52300, 301000),
+]
+
+
+def ts_percent(r25, beta, rt1, rt2, temp_c):
+    rntc = r25 * math.exp(beta * (1.0 / (temp_c + 273.15) - 1.0 / 298.15))
+    rlow = rt2 * rntc / (rt2 + rntc)
+    return 100.0 * rlow / (rt1 + rlow)
+
+
+def main():
+    temps = list(range(T_MIN_C, T_MAX_C + 1, T_STEP_C))
+    print("/**")
+    print(" *  @brief     NTC lookup tables for the BQ25895 charge controller IC.")
+    print(" *  @author    Sumant Khalate www.github.com/SumantKhalate/BQ25895")
+    print(" *  @date      May 2023")
+    print(" *  @copyright GPL-3.0 license.")
+    print(" *  @note      Generated by Tools/ntc_table.py, do not edit.")
+    print(" */")
+    print()
+    print("#ifdef __cplusplus")
+    print('extern "C" {')
+    print("#endif")
+    print()
+    print('#include "main.h"')
+    print('#include "BQ25895_NTC.h"')
+    print()
+    for name, r25, beta, rt1, rt2 in PROFILES:
+        values = [round(ts_percent(r25, beta, rt1, rt2, t) * 100) for t in temps]
+        print("/* R25 = %d, B = %d, RT1 = %d, RT2 = %d */" % (r25, beta, rt1, rt2))
+        print("static const uint16_t %s_PCT[] = {" % name)
+        for i in range(0, len(values), 10):
+            print("    " + ", ".join("%d" % v for v in values[i:i + 10]) + ",")
+        print("};")
+        print()
+    print("const BQ25895_NTC_TABLE BQ25895_NTC_TABLES[BQ25895_NTC_PROFILE_COUNT] = {")
+    for name, *_ in PROFILES:
+        print("    [%s] = { %d, %d, sizeof(%s_PCT) / sizeof(%s_PCT[0]), %s_PCT }," % (
+            name, T_MIN_C * 10, T_STEP_C * 10, name, name, name))
+    print("};")
+    print()
+    print("#ifdef __cplusplus")
+    print("}")
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main()